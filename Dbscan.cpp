@@ -0,0 +1,267 @@
+#include "Dbscan.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include "Trace.h"
+using namespace std;
+
+namespace {
+    // Cells per axis are capped so that row * cols + column fits in 64 bits.
+    constexpr double MaxCellsPerAxis = 1u << 30;
+
+    // Calls task(begin, end, worker) on chunks of [0, count) from `threads` workers.
+    template<typename Task>
+    void parallelChunks(size_t count, int threads, Task&& task) {
+        constexpr size_t Chunk = 256;
+        atomic<size_t> next(0);
+        auto worker = [&](int id) {
+            for (;;) {
+                size_t begin = next.fetch_add(Chunk);
+                if (begin >= count) return;
+                task(begin, min(count, begin + Chunk), id);
+            }
+        };
+        vector<thread> workers;
+        for (int t = 1; t < threads; t++) workers.emplace_back(worker, t);
+        worker(0);
+        for (auto& w : workers) w.join();
+    }
+
+    // Points sorted by cell; every cell is a contiguous range of slots.
+    struct CellGrid {
+        uint64_t cols = 1;
+        vector<uint64_t> cellKeys; // sorted, unique
+        vector<int> cellStart;     // slots of cell c: [cellStart[c], cellStart[c + 1])
+        vector<int> slotCell;
+        vector<int> order;         // slot -> point
+        vector<double> xs, ys;     // coordinates by slot
+
+        // Cell ranges [first, end) of the up to 5 rows of cells that can hold points
+        // within eps of cell c (c included); empty rows are stored as first == end.
+        vector<int> rowRanges; // 10 ints per cell
+
+        void computeNeighborRows(size_t c) {
+            uint64_t key = cellKeys[c];
+            uint64_t cx = key % cols, cy = key / cols;
+            int* out = &rowRanges[c * 10];
+            for (int dy = -2; dy <= 2; dy++, out += 2) {
+                out[0] = out[1] = 0;
+                if (dy < 0 && cy < static_cast<uint64_t>(-dy)) continue;
+                uint64_t row = cy + dy;
+                uint64_t reach = (dy == -2 || dy == 2) ? 1 : 2; // corner cells are out of range
+                uint64_t lo = row * cols + (cx > reach ? cx - reach : 0);
+                uint64_t hi = row * cols + min(cx + reach, cols - 1);
+                // Rows above start after c, rows below end before it.
+                auto from = dy > 0 ? cellKeys.begin() + c : cellKeys.begin();
+                auto to = dy < 0 ? cellKeys.begin() + c : cellKeys.end();
+                size_t first = lower_bound(from, to, lo) - cellKeys.begin();
+                size_t end = upper_bound(cellKeys.begin() + first, to, hi) - cellKeys.begin();
+                out[0] = static_cast<int>(first);
+                out[1] = static_cast<int>(max(first, end));
+            }
+        }
+
+        // Calls fn(firstCell, endCell) for each non-empty neighbor row of cell c;
+        // stops early if fn returns true.
+        template<typename Fn>
+        void forNeighborRows(size_t c, Fn&& fn) const {
+            const int* range = &rowRanges[c * 10];
+            for (int r = 0; r < 5; r++, range += 2)
+                if (range[0] < range[1] && fn(static_cast<size_t>(range[0]), static_cast<size_t>(range[1]))) return;
+        }
+    };
+
+    // Returns false if the extent forced cells larger than `side`: points of one
+    // cell are then no longer all within eps of each other.
+    bool buildGrid(CellGrid& grid, const vector<double>& xs, const vector<double>& ys, size_t n, double side) {
+        double minX = numeric_limits<double>::infinity(), minY = minX;
+        double maxX = -minX, maxY = -minX;
+        for (size_t i = 0; i < n; i++) {
+            minX = min(minX, xs[i]);
+            minY = min(minY, ys[i]);
+            maxX = max(maxX, xs[i]);
+            maxY = max(maxY, ys[i]);
+        }
+        // Huge extents coarsen the grid. Neighbor rows still cover eps, but a cell
+        // is no longer a clique.
+        double coarse = max(maxX - minX, maxY - minY) / MaxCellsPerAxis;
+        bool exact = coarse <= side;
+        side = max(side, coarse);
+        grid.cols = static_cast<uint64_t>((maxX - minX) / side) + 1;
+
+        vector<pair<uint64_t, int>> keyed(n);
+        for (size_t i = 0; i < n; i++) {
+            uint64_t cx = min(static_cast<uint64_t>((xs[i] - minX) / side), grid.cols - 1);
+            uint64_t cy = static_cast<uint64_t>((ys[i] - minY) / side);
+            keyed[i] = { cy * grid.cols + cx, static_cast<int>(i) };
+        }
+        sort(keyed.begin(), keyed.end());
+
+        grid.order.resize(n);
+        grid.slotCell.resize(n);
+        grid.xs.resize(n);
+        grid.ys.resize(n);
+        for (size_t s = 0; s < n; s++) {
+            if (s == 0 || keyed[s].first != keyed[s - 1].first) {
+                grid.cellKeys.push_back(keyed[s].first);
+                grid.cellStart.push_back(static_cast<int>(s));
+            }
+            int i = keyed[s].second;
+            grid.order[s] = i;
+            grid.slotCell[s] = static_cast<int>(grid.cellKeys.size()) - 1;
+            grid.xs[s] = xs[i];
+            grid.ys[s] = ys[i];
+        }
+        grid.cellStart.push_back(static_cast<int>(n));
+        return exact;
+    }
+
+    struct UnionFind {
+        vector<int> parent;
+        explicit UnionFind(size_t n) : parent(n) {
+            for (size_t i = 0; i < n; i++) parent[i] = static_cast<int>(i);
+        }
+        int find(int v) {
+            while (parent[v] != v) {
+                parent[v] = parent[parent[v]];
+                v = parent[v];
+            }
+            return v;
+        }
+        void unite(int a, int b) {
+            a = find(a);
+            b = find(b);
+            if (a != b) parent[max(a, b)] = min(a, b);
+        }
+    };
+}
+
+DbscanResult dbscan(const vector<double>& xs, const vector<double>& ys, double eps, int minPoints, int threads) {
+    TRACE_SCOPE("clustering", "dbscan");
+    DbscanResult result;
+    size_t n = min(xs.size(), ys.size());
+    result.labels.assign(n, -1);
+    result.core.assign(n, 0);
+    if (n == 0 || !(eps > 0)) return result;
+    threads = max(1, threads);
+    const double eps2 = eps * eps;
+
+    CellGrid grid;
+    // With exact cells, clusters are formed per cell; with a coarsened grid, per point.
+    bool exact = buildGrid(grid, xs, ys, n, eps / sqrt(2.0));
+    size_t cells = grid.cellKeys.size();
+    auto within = [&grid, eps2](int s, int t) {
+        double dx = grid.xs[s] - grid.xs[t], dy = grid.ys[s] - grid.ys[t];
+        return dx * dx + dy * dy <= eps2;
+    };
+
+    grid.rowRanges.resize(cells * 10);
+    parallelChunks(cells, threads, [&](size_t begin, size_t end, int) {
+        for (size_t c = begin; c < end; c++) grid.computeNeighborRows(c);
+    });
+
+    // 1. Core points.
+    vector<char> coreSlot(n, 0);
+    parallelChunks(cells, threads, [&](size_t begin, size_t end, int) {
+        for (size_t c = begin; c < end; c++) {
+            int s0 = grid.cellStart[c], s1 = grid.cellStart[c + 1];
+            if (exact && s1 - s0 >= minPoints) {
+                fill(coreSlot.begin() + s0, coreSlot.begin() + s1, 1);
+                continue;
+            }
+            for (int s = s0; s < s1; s++) {
+                int count = exact ? s1 - s0 : 0;
+                grid.forNeighborRows(c, [&](size_t first, size_t last) {
+                    for (int t = grid.cellStart[first]; t < grid.cellStart[last]; t++)
+                        if ((!exact || t < s0 || t >= s1) && within(s, t)) count++;
+                    return count >= minPoints;
+                });
+                coreSlot[s] = count >= minPoints;
+            }
+        }
+    });
+
+    // 2. Merge neighboring cells whose core points come within eps (core points
+    //    themselves on a coarsened grid). The tests run in parallel and collect
+    //    edges; the (cheap) unions are applied afterwards.
+    vector<char> cellHasCore(cells, 0);
+    for (size_t s = 0; s < n; s++)
+        if (coreSlot[s]) cellHasCore[grid.slotCell[s]] = 1;
+    vector<vector<pair<int, int>>> edges(threads);
+    parallelChunks(cells, threads, [&](size_t begin, size_t end, int worker) {
+        for (size_t c = begin; c < end; c++) {
+            if (!cellHasCore[c]) continue;
+            grid.forNeighborRows(c, [&](size_t first, size_t last) {
+                if (!exact) {
+                    for (int s = grid.cellStart[c]; s < grid.cellStart[c + 1]; s++) {
+                        if (!coreSlot[s]) continue;
+                        for (int t = max(grid.cellStart[first], s + 1); t < grid.cellStart[last]; t++)
+                            if (coreSlot[t] && within(s, t)) edges[worker].push_back({ s, t });
+                    }
+                    return false;
+                }
+                for (size_t d = max(first, c + 1); d < last; d++) {
+                    if (!cellHasCore[d]) continue;
+                    bool linked = false;
+                    for (int s = grid.cellStart[c]; s < grid.cellStart[c + 1] && !linked; s++) {
+                        if (!coreSlot[s]) continue;
+                        for (int t = grid.cellStart[d]; t < grid.cellStart[d + 1] && !linked; t++)
+                            linked = coreSlot[t] && within(s, t);
+                    }
+                    if (linked) edges[worker].push_back({ static_cast<int>(c), static_cast<int>(d) });
+                }
+                return false;
+            });
+        }
+    });
+    size_t units = exact ? cells : n;
+    UnionFind sets(units);
+    for (auto const& list : edges)
+        for (auto const& [a, b] : list) sets.unite(a, b);
+    vector<int> unitRoot(units);
+    for (size_t u = 0; u < units; u++) unitRoot[u] = sets.find(static_cast<int>(u));
+    auto rootOf = [&](int s) { return unitRoot[exact ? grid.slotCell[s] : s]; };
+
+    // 3. Raw labels (root unit) for core points, nearest core point for the rest.
+    vector<int> rawLabel(n, -1);
+    parallelChunks(cells, threads, [&](size_t begin, size_t end, int) {
+        for (size_t c = begin; c < end; c++) {
+            for (int s = grid.cellStart[c]; s < grid.cellStart[c + 1]; s++) {
+                if (coreSlot[s]) {
+                    rawLabel[s] = rootOf(s);
+                    continue;
+                }
+                double best = numeric_limits<double>::infinity();
+                grid.forNeighborRows(c, [&](size_t first, size_t last) {
+                    for (int t = grid.cellStart[first]; t < grid.cellStart[last]; t++) {
+                        if (!coreSlot[t]) continue;
+                        double dx = grid.xs[s] - grid.xs[t], dy = grid.ys[s] - grid.ys[t];
+                        double d2 = dx * dx + dy * dy;
+                        if (d2 <= eps2 && d2 < best) {
+                            best = d2;
+                            rawLabel[s] = rootOf(t);
+                        }
+                    }
+                    return false;
+                });
+            }
+        }
+    });
+
+    // 4. Number clusters in order of their first point.
+    vector<int> slotOf(n);
+    for (size_t s = 0; s < n; s++) slotOf[grid.order[s]] = static_cast<int>(s);
+    vector<int> clusterOfRoot(units, -1);
+    for (size_t i = 0; i < n; i++) {
+        int s = slotOf[i];
+        result.core[i] = coreSlot[s];
+        int root = rawLabel[s];
+        if (root < 0) continue;
+        if (clusterOfRoot[root] < 0) clusterOfRoot[root] = result.clusterCount++;
+        result.labels[i] = clusterOfRoot[root];
+    }
+    return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <thread>
+#include <vector>
+#include "Environment.h"
+using namespace std;
+
+struct DbscanResult {
+    vector<int> labels;  // cluster id per point, -1 = noise
+    vector<char> core;   // 1 if the point is a core point
+    int clusterCount = 0;
+};
+
+// DBSCAN over 2D points: a point with at least minPoints points (itself included)
+// within eps is a core point; core points within eps of each other share a
+// cluster, and every other point joins the cluster of its nearest core point
+// within eps or is noise.
+//
+// Points are bucketed into grid cells of side eps / sqrt(2), so all points of one
+// cell are neighbors of each other and a cell with minPoints points is entirely
+// core. Neighborhood queries only visit the 21 cells that can hold points within
+// eps. Clusters are formed per cell: neighboring cells whose core points come
+// within eps are merged with union-find. Core detection, cell merging tests and
+// border assignment run in parallel over cells. If the extent is so large that
+// the grid must be coarsened (over 2^30 cells per axis), cells are no longer
+// cliques and clusters are formed per core point instead.
+// Cluster ids are numbered in order of the first point of each cluster.
+DbscanResult dbscan(const vector<double>& xs, const vector<double>& ys, double eps, int minPoints,
+    int threads = static_cast<int>(thread::hardware_concurrency()));
+
+// Clusters the coordinates of map objects (e.g. traffic-jam Obstacle reports).
+template<typename Object>
+DbscanResult dbscan(const vector<Object>& objects, double eps, int minPoints,
+    int threads = static_cast<int>(thread::hardware_concurrency())) {
+    vector<double> xs, ys;
+    xs.reserve(objects.size());
+    ys.reserve(objects.size());
+    for (const MapObject& o : objects) {
+        xs.push_back(o.getX());
+        ys.push_back(o.getY());
+    }
+    return dbscan(xs, ys, eps, minPoints, threads);
+}
@@ -0,0 +1,167 @@
+#include "DenseMST.h"
+#include <cmath>
+#include <limits>
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define DENSE_MST_HAVE_AVX2 1
+#endif
+using namespace std;
+
+namespace {
+    int argminScalar(const double* values, int count) {
+        int best = 0;
+        for (int i = 1; i < count; i++)
+            if (values[i] < values[best]) best = i;
+        return best;
+    }
+
+#ifdef DENSE_MST_HAVE_AVX2
+    // Four running minima with their indices, reduced at the end.
+    __attribute__((target("avx2")))
+    int argminAvx2(const double* values, int count) {
+        if (count < 8) return argminScalar(values, count);
+        __m256d bestValue = _mm256_loadu_pd(values);
+        __m256d bestIndex = _mm256_setr_pd(0, 1, 2, 3);
+        __m256d index = bestIndex;
+        const __m256d step = _mm256_set1_pd(4);
+        int i = 4;
+        for (; i + 4 <= count; i += 4) {
+            index = _mm256_add_pd(index, step);
+            __m256d v = _mm256_loadu_pd(values + i);
+            __m256d less = _mm256_cmp_pd(v, bestValue, _CMP_LT_OQ);
+            bestValue = _mm256_blendv_pd(bestValue, v, less);
+            bestIndex = _mm256_blendv_pd(bestIndex, index, less);
+        }
+        alignas(32) double lanesValue[4], lanesIndex[4];
+        _mm256_store_pd(lanesValue, bestValue);
+        _mm256_store_pd(lanesIndex, bestIndex);
+        int best = static_cast<int>(lanesIndex[0]);
+        for (int k = 1; k < 4; k++) {
+            int idx = static_cast<int>(lanesIndex[k]);
+            if (lanesValue[k] < values[best] || (lanesValue[k] == values[best] && idx < best)) best = idx;
+        }
+        for (; i < count; i++)
+            if (values[i] < values[best]) best = i;
+        return best;
+    }
+
+    bool cpuHasAvx2() {
+        static const bool has = __builtin_cpu_supports("avx2");
+        return has;
+    }
+#endif
+
+    // Vertices outside the tree, packed in [0, size).
+    struct Remaining {
+        vector<double> key;
+        vector<int> id;
+        vector<int> parent;
+
+        explicit Remaining(int n) : key(n, numeric_limits<double>::infinity()), id(n), parent(n, -1) {
+            for (int i = 0; i < n; i++) id[i] = i;
+        }
+        // Swaps slot i with the last one and drops it.
+        void remove(int i) {
+            int last = static_cast<int>(id.size()) - 1;
+            key[i] = key[last];
+            id[i] = id[last];
+            parent[i] = parent[last];
+            key.pop_back();
+            id.pop_back();
+            parent.pop_back();
+        }
+    };
+}
+
+int dense_argmin(const double* values, int count) {
+    if (count <= 0) return -1;
+#ifdef DENSE_MST_HAVE_AVX2
+    if (cpuHasAvx2()) return argminAvx2(values, count);
+#endif
+    return argminScalar(values, count);
+}
+
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<double>& xs, const vector<double>& ys) {
+    vector<pair<int, int>> mstEdges;
+    double totalWeight = 0;
+    int n = static_cast<int>(min(xs.size(), ys.size()));
+    if (n == 0) return { mstEdges, 0 };
+
+    Remaining rest(n);
+    // Coordinates of the remaining vertices, packed alongside `rest`.
+    vector<double> rx(xs.begin(), xs.begin() + n), ry(ys.begin(), ys.begin() + n);
+
+    int u = 0;
+    rest.remove(0);
+    rx[0] = rx[n - 1]; rx.pop_back();
+    ry[0] = ry[n - 1]; ry.pop_back();
+
+    while (!rest.id.empty()) {
+        const double ux = xs[u], uy = ys[u];
+        int m = static_cast<int>(rest.id.size());
+        double* key = rest.key.data();
+        int* parent = rest.parent.data();
+        const double* px = rx.data();
+        const double* py = ry.data();
+        for (int i = 0; i < m; i++) {
+            double dx = px[i] - ux, dy = py[i] - uy;
+            double d = dx * dx + dy * dy;
+            bool better = d < key[i];
+            key[i] = better ? d : key[i];
+            parent[i] = better ? u : parent[i];
+        }
+
+        int best = dense_argmin(key, m);
+        int v = rest.id[best];
+        mstEdges.push_back({ rest.parent[best], v });
+        totalWeight += sqrt(rest.key[best]);
+        u = v;
+
+        rest.remove(best);
+        rx[best] = rx[m - 1]; rx.pop_back();
+        ry[best] = ry[m - 1]; ry.pop_back();
+    }
+    return { mstEdges, totalWeight };
+}
+
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<Point>& points) {
+    vector<double> xs, ys;
+    xs.reserve(points.size());
+    ys.reserve(points.size());
+    for (auto const& p : points) {
+        xs.push_back(p.getX());
+        ys.push_back(p.getY());
+    }
+    return mst_prim_dense(xs, ys);
+}
+
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<double>& weights, int n) {
+    vector<pair<int, int>> mstEdges;
+    double totalWeight = 0;
+    if (n <= 0 || weights.size() < static_cast<size_t>(n) * n) return { mstEdges, 0 };
+
+    Remaining rest(n);
+    int u = 0;
+    rest.remove(0);
+
+    while (!rest.id.empty()) {
+        const double* row = weights.data() + static_cast<size_t>(u) * n;
+        int m = static_cast<int>(rest.id.size());
+        for (int i = 0; i < m; i++) {
+            double w = row[rest.id[i]];
+            if (w >= 0 && w < rest.key[i]) {
+                rest.key[i] = w;
+                rest.parent[i] = u;
+            }
+        }
+
+        int best = dense_argmin(rest.key.data(), m);
+        if (rest.key[best] == numeric_limits<double>::infinity()) break; // rest is unreachable
+        int v = rest.id[best];
+        mstEdges.push_back({ rest.parent[best], v });
+        totalWeight += rest.key[best];
+        u = v;
+        rest.remove(best);
+    }
+    return { mstEdges, totalWeight };
+}
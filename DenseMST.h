@@ -0,0 +1,25 @@
+#pragma once
+#include <utility>
+#include <vector>
+#include "Environment.h"
+using namespace std;
+
+// Prim's algorithm for complete or near-complete graphs in O(V^2) time and O(V) memory.
+//
+// Instead of a heap of O(V^2) candidate edges it keeps, for every vertex not yet
+// in the tree, the cheapest known connection (key) and picks the smallest key
+// each round with a vectorized argmin (AVX2 when the CPU has it, scalar otherwise).
+// Vertices still outside the tree are kept in packed arrays, so every round is a
+// linear pass without masks. Edges are pairs of indices into the input.
+
+// All-pairs candidate links between points, weight = Euclidean distance computed
+// on the fly (squared distances are compared, which yields the same tree).
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<Point>& points);
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<double>& xs, const vector<double>& ys);
+
+// Row-major n x n weight matrix of an undirected graph; negative entries mean
+// "no edge". Like Graph::mst_prim, only the component of vertex 0 is spanned.
+pair<vector<pair<int, int>>, double> mst_prim_dense(const vector<double>& weights, int n);
+
+// Index of the smallest of values[0..count), -1 if count == 0.
+int dense_argmin(const double* values, int count);
@@ -0,0 +1,158 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define EDGE_RELAX_HAVE_X86 1
+#endif
+using namespace std;
+
+enum class RelaxKernel { Scalar, Avx2, Avx512 };
+
+namespace edge_relax_detail {
+    inline int relaxScalar(const int* targets, const int* weights, int count, long long du, int u,
+        long long* dist, int* parent, int* improvedVertex, long long* improvedDist) {
+        int improved = 0;
+        for (int i = 0; i < count; i++) {
+            int v = targets[i];
+            long long nd = du + weights[i];
+            if (nd < dist[v]) {
+                dist[v] = nd;
+                parent[v] = u;
+                improvedVertex[improved] = v;
+                improvedDist[improved] = nd;
+                improved++;
+            }
+        }
+        return improved;
+    }
+
+#ifdef EDGE_RELAX_HAVE_X86
+    // Four edges per step: gather the target distances and compare. AVX2 has no
+    // scatter, so the (usually few) improvements are written one by one,
+    // re-checked in case an earlier lane improved the same target.
+    __attribute__((target("avx2")))
+    inline int relaxAvx2(const int* targets, const int* weights, int count, long long du, int u,
+        long long* dist, int* parent, int* improvedVertex, long long* improvedDist) {
+        const __m256i base = _mm256_set1_epi64x(du);
+        int improved = 0, i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128i index = _mm_loadu_si128(reinterpret_cast<const __m128i*>(targets + i));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights + i));
+            __m256i nd = _mm256_add_epi64(base, _mm256_cvtepi32_epi64(w));
+            __m256i old = _mm256_i32gather_epi64(dist, index, 8);
+            int better = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(old, nd)));
+            for (; better; better &= better - 1) {
+                int k = __builtin_ctz(better);
+                int v = targets[i + k];
+                long long d = du + weights[i + k];
+                if (d < dist[v]) {
+                    dist[v] = d;
+                    parent[v] = u;
+                    improvedVertex[improved] = v;
+                    improvedDist[improved] = d;
+                    improved++;
+                }
+            }
+        }
+        return improved + relaxScalar(targets + i, weights + i, count - i, du, u, dist, parent,
+            improvedVertex + improved, improvedDist + improved);
+    }
+
+    // Eight edges per step: gather, compare into a mask, masked scatter of dist
+    // and parent, and compress-store of the improved (vertex, distance) pairs.
+    // When two lanes hit the same target the highest lane's write wins, which
+    // need not be the smaller distance; re-reading the written lanes finds those.
+    // The widening and the first gather use full-mask forms; the unmasked ones
+    // trip GCC's -Wmaybe-uninitialized.
+    __attribute__((target("avx512f,avx512vl")))
+    inline int relaxAvx512(const int* targets, const int* weights, int count, long long du, int u,
+        long long* dist, int* parent, int* improvedVertex, long long* improvedDist) {
+        const __m512i base = _mm512_set1_epi64(du);
+        const __m256i owner = _mm256_set1_epi32(u);
+        int improved = 0, i = 0;
+        for (; i + 8 <= count; i += 8) {
+            __m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(targets + i));
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(weights + i));
+            __m512i nd = _mm512_add_epi64(base, _mm512_maskz_cvtepi32_epi64(0xFF, w));
+            __m512i old = _mm512_mask_i32gather_epi64(nd, 0xFF, index, dist, 8);
+            __mmask8 better = _mm512_cmplt_epi64_mask(nd, old);
+            if (!better) continue;
+            _mm512_mask_i32scatter_epi64(dist, better, index, nd, 8);
+            _mm256_mask_i32scatter_epi32(parent, better, index, owner, 4);
+            _mm256_mask_compressstoreu_epi32(improvedVertex + improved, better, index);
+            _mm512_mask_compressstoreu_epi64(improvedDist + improved, better, nd);
+            improved += __builtin_popcount(better);
+
+            __m512i written = _mm512_mask_i32gather_epi64(nd, better, index, dist, 8);
+            for (unsigned lost = _mm512_mask_cmpneq_epi64_mask(better, written, nd); lost; lost &= lost - 1) {
+                int k = __builtin_ctz(lost);
+                int v = targets[i + k];
+                long long d = du + weights[i + k];
+                if (d < dist[v]) dist[v] = d;
+            }
+        }
+        return improved + relaxScalar(targets + i, weights + i, count - i, du, u, dist, parent,
+            improvedVertex + improved, improvedDist + improved);
+    }
+#endif
+
+    inline RelaxKernel widestKernel();
+
+    inline atomic<RelaxKernel>& selectedKernel() {
+        static atomic<RelaxKernel> kernel{ widestKernel() };
+        return kernel;
+    }
+}
+
+inline bool relax_kernel_supported(RelaxKernel kernel) {
+#ifdef EDGE_RELAX_HAVE_X86
+    __builtin_cpu_init(); // may run from a static initializer
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    static const bool avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl");
+    if (kernel == RelaxKernel::Avx2) return avx2;
+    if (kernel == RelaxKernel::Avx512) return avx512;
+#endif
+    return kernel == RelaxKernel::Scalar;
+}
+
+inline RelaxKernel edge_relax_detail::widestKernel() {
+    if (relax_kernel_supported(RelaxKernel::Avx512)) return RelaxKernel::Avx512;
+    if (relax_kernel_supported(RelaxKernel::Avx2)) return RelaxKernel::Avx2;
+    return RelaxKernel::Scalar;
+}
+
+// Kernel used by relax_edges: the widest one the CPU supports, unless changed
+// with select_relax_kernel (benchmarks, tests). False if the CPU lacks it.
+inline RelaxKernel active_relax_kernel() { return edge_relax_detail::selectedKernel().load(memory_order_relaxed); }
+inline bool select_relax_kernel(RelaxKernel kernel) {
+    if (!relax_kernel_supported(kernel)) return false;
+    edge_relax_detail::selectedKernel().store(kernel, memory_order_relaxed);
+    return true;
+}
+
+// Relaxes the `count` out-edges of a settled vertex u at distance du, stored
+// contiguously (CSR): for each edge with nd = du + weights[i] < dist[targets[i]],
+// sets dist and parent and appends (target, nd) to improvedVertex / improvedDist,
+// which must have room for `count` entries. Returns the number appended.
+//
+// The final dist and parent are those of the plain loop. A target reached by
+// parallel edges may be reported more than once; entries above its final
+// distance are stale, as lazy-deletion Dijkstra expects. Short adjacency lists
+// (under eight edges, e.g. road networks) always take the scalar loop.
+inline int relax_edges(const int* targets, const int* weights, int count, long long du, int u,
+    long long* dist, int* parent, int* improvedVertex, long long* improvedDist) {
+#ifdef EDGE_RELAX_HAVE_X86
+    if (count >= 8) {
+        switch (active_relax_kernel()) {
+        case RelaxKernel::Avx512:
+            return edge_relax_detail::relaxAvx512(targets, weights, count, du, u, dist, parent, improvedVertex, improvedDist);
+        case RelaxKernel::Avx2:
+            return edge_relax_detail::relaxAvx2(targets, weights, count, du, u, dist, parent, improvedVertex, improvedDist);
+        default:
+            break;
+        }
+    }
+#endif
+    return edge_relax_detail::relaxScalar(targets, weights, count, du, u, dist, parent, improvedVertex, improvedDist);
+}
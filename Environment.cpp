@@ -27,14 +27,94 @@ void Route::showRoute() const {
 }
 
 double Route::getDistance() const { return distance; }
-Point Route::getStart() const { return start; }
-Point Route::getDestination() const { return destination; }
+const Point& Route::getStart() const { return start; }
+const Point& Route::getDestination() const { return destination; }
 
 
 
 // Environment
-void Environment::addRoute(const Route& route) {
+int Environment::internPoint(const string& name) {
+    auto [it, inserted] = pointIds.emplace(name, static_cast<int>(routesAtPoint.size()));
+    if (inserted) routesAtPoint.emplace_back();
+    return it->second;
+}
+
+int Environment::pointId(const string& name) const {
+    auto it = pointIds.find(name);
+    return it == pointIds.end() ? -1 : it->second;
+}
+
+uint64_t Environment::endpointKey(int start, int destination) {
+    return (static_cast<uint64_t>(start) << 32) | static_cast<uint32_t>(destination);
+}
+
+bool Environment::addRoute(const Route& route) {
+    int a = internPoint(route.getStart().getName());
+    int b = internPoint(route.getDestination().getName());
+    auto [it, inserted] = routeByEndpoints.emplace(endpointKey(a, b), static_cast<int>(routes.size()));
+    if (!inserted) {
+        routes[it->second] = route;
+        return false;
+    }
+    int position = it->second;
     routes.push_back(route);
+    RouteLinks link = { a, b, static_cast<int>(routesAtPoint[a].size()), -1 };
+    routesAtPoint[a].push_back(position);
+    if (b != a) {
+        link.destinationSlot = static_cast<int>(routesAtPoint[b].size());
+        routesAtPoint[b].push_back(position);
+    }
+    links.push_back(link);
+    return true;
+}
+
+const Route* Environment::findRoute(const string& from, const string& to) const {
+    int a = pointId(from), b = pointId(to);
+    if (a < 0 || b < 0) return nullptr;
+    auto it = routeByEndpoints.find(endpointKey(a, b));
+    return it == routeByEndpoints.end() ? nullptr : &routes[it->second];
+}
+
+// Removes entry `slot` of a point's list by moving its last entry there.
+void Environment::unlinkSlot(int point, int slot) {
+    vector<int>& list = routesAtPoint[point];
+    int moved = list.back();
+    list[slot] = moved;
+    list.pop_back();
+    if (slot == static_cast<int>(list.size())) return;
+    RouteLinks& link = links[moved];
+    if (link.start == point) link.startSlot = slot;
+    else link.destinationSlot = slot;
+}
+
+bool Environment::removeRoute(const string& from, const string& to) {
+    int a = pointId(from), b = pointId(to);
+    if (a < 0 || b < 0) return false;
+    auto it = routeByEndpoints.find(endpointKey(a, b));
+    if (it == routeByEndpoints.end()) return false;
+    int position = it->second;
+    routeByEndpoints.erase(it);
+    unlinkSlot(a, links[position].startSlot);
+    if (b != a) unlinkSlot(b, links[position].destinationSlot);
+
+    int last = static_cast<int>(routes.size()) - 1;
+    if (position != last) {
+        routes[position] = routes[last];
+        links[position] = links[last];
+        const RouteLinks& moved = links[position];
+        routesAtPoint[moved.start][moved.startSlot] = position;
+        if (moved.destinationSlot >= 0) routesAtPoint[moved.destination][moved.destinationSlot] = position;
+        routeByEndpoints[endpointKey(moved.start, moved.destination)] = position;
+    }
+    routes.pop_back();
+    links.pop_back();
+    return true;
+}
+
+const vector<int>& Environment::routesAt(const string& point) const {
+    static const vector<int> none;
+    int id = pointId(point);
+    return id < 0 ? none : routesAtPoint[id];
 }
 
 void Environment::addObstacle(const Obstacle& obs) {
@@ -67,6 +147,10 @@ const vector<Obstacle>& Environment::getObstacles() const {
 
 void Environment::clearRoutes() {
     routes.clear();
+    links.clear();
+    routeByEndpoints.clear();
+    routesAtPoint.clear();
+    pointIds.clear();
 }
 
 void Environment::clearObstacles() {
@@ -74,6 +158,8 @@ void Environment::clearObstacles() {
 }
 
 vector<int> Environment::findOptimalRoute(Graph<int>& graph, int start, int end, Transport& transport) {
+    TRACE_SCOPE("environment", "findOptimalRoute");
+    METRICS_LATENCY("findOptimalRoute");
     cout << "\nFinding optimal route for " << transport.getName() << "...\n";
     auto [path, distance] = graph.shortest_path(start, end, true);
     cout << "Optimal route: ";
@@ -83,6 +169,7 @@ vector<int> Environment::findOptimalRoute(Graph<int>& graph, int start, int end,
 }
 
 void Environment::moveTransport(Transport& transport, const vector<int>& route) {
+    TRACE_SCOPE("simulation", "moveTransport");
     cout << "\n" << transport.getName() << " moves along the route: ";
     for (int v : route) cout << v << " ";
     cout << endl;
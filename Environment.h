@@ -1,6 +1,8 @@
 #pragma once
+#include <cstdint>
 #include <iostream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "Transport.h"
 #include "Graph.h" 
@@ -45,8 +47,8 @@ public:
     Route(Point s, Point d, double dist);
     void showRoute() const;
     double getDistance() const;
-    Point getStart() const;
-    Point getDestination() const;
+    const Point& getStart() const;
+    const Point& getDestination() const;
 };
 
 
@@ -54,8 +56,36 @@ public:
 class Environment {
     vector<Route> routes;
     vector<Obstacle> obstacles;
+
+    // Route index. Point names are interned to ids; a route is identified by its
+    // (start, destination) ids. links[i] belongs to routes[i] and records where the
+    // route sits in the per-point lists, so removal is O(1) (swap with the last route).
+    struct RouteLinks {
+        int start, destination;
+        int startSlot, destinationSlot; // destinationSlot = -1 for a loop
+    };
+    unordered_map<string, int> pointIds;
+    vector<vector<int>> routesAtPoint; // point id -> positions in routes
+    vector<RouteLinks> links;
+    unordered_map<uint64_t, int> routeByEndpoints;
+
+    int internPoint(const string& name);
+    int pointId(const string& name) const;
+    static uint64_t endpointKey(int start, int destination);
+    void unlinkSlot(int point, int slot);
 public:
-    void addRoute(const Route& route);
+    // Adds a route, or replaces the route with the same start and destination
+    // names (routes are directed here: A->B and B->A are different routes).
+    // Returns false if an existing route was replaced.
+    bool addRoute(const Route& route);
+    // nullptr if there is no route from -> to.
+    const Route* findRoute(const string& from, const string& to) const;
+    bool removeRoute(const string& from, const string& to);
+    // Positions in getRoutes() of the routes starting or ending at a point.
+    // removeRoute moves the last route into the freed position.
+    const vector<int>& routesAt(const string& point) const;
+    size_t pointCount() const { return pointIds.size(); }
+
     void addObstacle(const Obstacle& obs);
     void showEnvironment() const;
 
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "EdgeRelax.h"
+#include "Graph.h"
+#include "GraphDelta.h"
+#include "PageAllocator.h"
+using namespace std;
+
+template<typename T>
+using FrozenArray = vector<T, PageAllocator<T>>;
+
+#if defined(__GNUC__) || defined(__clang__)
+#define FROZEN_PREFETCH(addr) __builtin_prefetch(addr)
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define FROZEN_PREFETCH(addr) _mm_prefetch(reinterpret_cast<const char*>(addr), _MM_HINT_T0)
+#else
+#define FROZEN_PREFETCH(addr) ((void)0)
+#endif
+
+inline int frozen_lowest_bit(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(bits);
+#else
+    int bit = 0;
+    while (!((bits >> bit) & 1)) bit++;
+    return bit;
+#endif
+}
+
+// Read-only snapshot of a Graph in compressed sparse row form.
+// Vertices are numbered 0..n-1 in the order of Graph's adjacency map; the
+// neighbors of vertex i are targets[offsets[i] .. offsets[i + 1]).
+template<typename VertexType>
+class FrozenGraph {
+    FrozenArray<VertexType> vertices; // index -> vertex, sorted
+    FrozenArray<int> offsets;
+    FrozenArray<int> targets;
+    FrozenArray<int> weights;
+    bool directed;
+    PageBacking backing;
+
+public:
+    explicit FrozenGraph(PageBacking pages = PageBacking::Default);
+    explicit FrozenGraph(const Graph<VertexType>& g, PageBacking pages = PageBacking::Default);
+
+    // Copy (same page backing) whose arrays are filled by copyArray(dst, src);
+    // used to control which threads touch the new pages first.
+    template<typename CopyFn>
+    FrozenGraph clone(CopyFn copyArray) const;
+
+    int vertex_count() const { return static_cast<int>(vertices.size()); }
+    size_t edge_count() const { return targets.size(); }
+    bool isDirected() const { return directed; }
+    PageBacking getPageBacking() const { return backing; }
+
+    // Index of v, or -1 if the graph has no such vertex.
+    int index_of(const VertexType& v) const;
+    const VertexType& vertex_at(int index) const { return vertices[index]; }
+
+    const FrozenArray<int>& getOffsets() const { return offsets; }
+    const FrozenArray<int>& getTargets() const { return targets; }
+    const FrozenArray<int>& getWeights() const { return weights; }
+
+    // Stores in `result` this graph with `delta` applied: the same snapshot as
+    // FrozenGraph(g) for the Graph g that apply_delta(g, delta) produces. Only the
+    // adjacency of edited vertices is rebuilt; the ranges of the others are block
+    // copies, or renumbered in one pass when vertices were added or removed.
+    // result keeps its own page backing and may be this graph. False (result
+    // untouched) if the directedness differs.
+    bool patch(const GraphDelta<VertexType>& delta, FrozenGraph& result) const;
+
+    // Shortest path (Dijkstra), same result convention as Graph::shortest_path.
+    // Edges of each settled vertex are relaxed with relax_edges (SIMD where available).
+    // The distance arrays are per-thread scratch kept between calls (sized for the
+    // largest graph the thread has queried).
+    pair<vector<VertexType>, int> shortest_path(VertexType start, VertexType end, bool print) const;
+
+    // Answers independent point-to-point queries by interleaving up to `interleave`
+    // Dijkstra searches in the calling thread. Each search is a small state machine
+    // that prefetches the adjacency it needs next and then yields to the others, so
+    // cache misses of different searches overlap. Results are in query order.
+    vector<pair<vector<VertexType>, int>> shortest_paths_batch(
+        const vector<pair<VertexType, VertexType>>& queries, int interleave = 8) const;
+
+    // Hop (unweighted) distances from each source, by bit-parallel multi-source BFS:
+    // up to 512 sources are traversed together with one bitset per vertex, so each
+    // adjacency scan serves all of them. result[i][v] is the hop count from
+    // sources[i] to the vertex with index v, or -1 if it is unreachable.
+    vector<vector<int>> multi_source_bfs(const vector<VertexType>& sources) const;
+
+private:
+    struct QueryLane;
+
+    template<size_t Words>
+    void multi_source_bfs_pass(const vector<int>& sourceIndices, size_t first, size_t count,
+        vector<vector<int>>& result) const;
+};
+
+#include "FrozenGraph.inl"
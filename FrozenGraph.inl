@@ -0,0 +1,484 @@
+#include "FrozenGraph.h"
+
+template<typename VertexType>
+FrozenGraph<VertexType>::FrozenGraph(PageBacking pages)
+    : vertices(pages), offsets(1, 0, pages), targets(pages), weights(pages), directed(false), backing(pages) {}
+
+template<typename VertexType>
+FrozenGraph<VertexType>::FrozenGraph(const Graph<VertexType>& g, PageBacking pages)
+    : vertices(pages), offsets(pages), targets(pages), weights(pages), directed(g.isDirected()), backing(pages) {
+    auto const& adj = g.getAdjacency();
+
+    vertices.reserve(adj.size());
+    for (auto const& [v, _] : adj)
+        vertices.push_back(v);
+
+    offsets.resize(adj.size() + 1);
+    offsets[0] = 0;
+    int i = 0;
+    size_t total = 0;
+    for (auto const& [_, neighbors] : adj) {
+        total += neighbors.size();
+        offsets[++i] = static_cast<int>(total);
+    }
+
+    targets.resize(total);
+    weights.resize(total);
+    size_t e = 0;
+    for (auto const& [_, neighbors] : adj) {
+        for (auto const& [to, w] : neighbors) {
+            targets[e] = index_of(to);
+            weights[e] = w;
+            e++;
+        }
+    }
+}
+
+template<typename VertexType>
+template<typename CopyFn>
+FrozenGraph<VertexType> FrozenGraph<VertexType>::clone(CopyFn copyArray) const {
+    FrozenGraph<VertexType> copy(backing);
+    copy.directed = directed;
+    copy.vertices = vertices; // VertexType may not be trivially copyable
+    copyArray(copy.offsets, offsets);
+    copyArray(copy.targets, targets);
+    copyArray(copy.weights, weights);
+    return copy;
+}
+
+template<typename VertexType>
+int FrozenGraph<VertexType>::index_of(const VertexType& v) const {
+    auto it = lower_bound(vertices.begin(), vertices.end(), v);
+    if (it == vertices.end() || *it != v) return -1;
+    return static_cast<int>(it - vertices.begin());
+}
+
+template<typename VertexType>
+bool FrozenGraph<VertexType>::patch(const GraphDelta<VertexType>& delta, FrozenGraph& result) const {
+    TRACE_SCOPE("graph", "frozen_patch");
+    if (delta.directed != directed) return false;
+    int n = vertex_count();
+
+    vector<char> removed(n, 0);
+    int removedCount = 0;
+    for (auto const& v : delta.removedVertices) {
+        int i = index_of(v);
+        if (i >= 0 && !removed[i]) {
+            removed[i] = 1;
+            removedCount++;
+        }
+    }
+    // Vertices to create: added ones and endpoints of added edges that are not
+    // survivors (a vertex removed and added again starts without edges).
+    vector<VertexType> fresh;
+    auto addFresh = [&](const VertexType& v) {
+        int i = index_of(v);
+        if (i < 0 || removed[i]) fresh.push_back(v);
+    };
+    for (auto const& v : delta.addedVertices) addFresh(v);
+    for (auto const& [u, v, w] : delta.addedEdges) {
+        addFresh(u);
+        addFresh(v);
+    }
+    sort(fresh.begin(), fresh.end());
+    fresh.erase(unique(fresh.begin(), fresh.end()), fresh.end());
+    bool sameVertices = fresh.empty() && removedCount == 0;
+
+    // Merge survivors and fresh vertices; remap: old index -> new index (-1 if
+    // removed), source: new index -> old index (-1 if fresh).
+    FrozenArray<VertexType> newVertices(backing);
+    vector<int> remap(n, -1), source;
+    newVertices.reserve(n - removedCount + fresh.size());
+    source.reserve(n - removedCount + fresh.size());
+    size_t f = 0;
+    for (int i = 0; i <= n; i++) {
+        while (f < fresh.size() && (i == n || fresh[f] < vertices[i])) {
+            source.push_back(-1);
+            newVertices.push_back(fresh[f++]);
+        }
+        if (i == n) break;
+        if (removed[i]) continue;
+        remap[i] = static_cast<int>(newVertices.size());
+        source.push_back(i);
+        newVertices.push_back(vertices[i]);
+    }
+    size_t m = newVertices.size();
+    auto newIndex = [&](const VertexType& v) {
+        return static_cast<int>(lower_bound(newVertices.begin(), newVertices.end(), v) - newVertices.begin());
+    };
+    auto survivor = [&](const VertexType& v) {
+        int i = index_of(v);
+        return i >= 0 ? remap[i] : -1;
+    };
+
+    // Edge edits per source vertex (new indices), in delta order.
+    struct Edit { int from, to, weight; };
+    vector<Edit> removals, reweights, appends;
+    auto addEdit = [&](vector<Edit>& edits, int u, int v, int w) {
+        edits.push_back({ u, v, w });
+        if (!directed && u != v) edits.push_back({ v, u, w });
+    };
+    for (auto const& [u, v] : delta.removedEdges) {
+        int a = survivor(u), b = survivor(v);
+        if (a >= 0 && b >= 0) addEdit(removals, a, b, 0);
+    }
+    for (auto const& [u, v, w] : delta.changedWeights) {
+        int a = survivor(u), b = survivor(v);
+        if (a >= 0 && b >= 0) addEdit(reweights, a, b, w);
+    }
+    for (auto const& [u, v, w] : delta.addedEdges)
+        addEdit(appends, newIndex(u), newIndex(v), w);
+    vector<char> dirty(m, 0);
+    for (auto* edits : { &removals, &reweights, &appends }) {
+        stable_sort(edits->begin(), edits->end(), [](const Edit& x, const Edit& y) { return x.from < y.from; });
+        for (auto const& edit : *edits) dirty[edit.from] = 1;
+    }
+
+    FrozenArray<int> newOffsets(backing), newTargets(backing), newWeights(backing);
+    newOffsets.reserve(m + 1);
+    newOffsets.push_back(0);
+    newTargets.reserve(targets.size() + appends.size());
+    newWeights.reserve(targets.size() + appends.size());
+    size_t r = 0, c = 0, a = 0; // cursors into removals, reweights, appends
+    for (size_t u = 0; u < m;) {
+        if (sameVertices && !dirty[u]) {
+            // Run of untouched vertices: indices are unchanged, copy the ranges.
+            size_t end = u;
+            while (end < m && !dirty[end]) end++;
+            int shift = static_cast<int>(newTargets.size()) - offsets[u];
+            newTargets.insert(newTargets.end(), targets.begin() + offsets[u], targets.begin() + offsets[end]);
+            newWeights.insert(newWeights.end(), weights.begin() + offsets[u], weights.begin() + offsets[end]);
+            for (size_t k = u + 1; k <= end; k++) newOffsets.push_back(offsets[k] + shift);
+            u = end;
+            continue;
+        }
+
+        size_t rEnd = r, cEnd = c, aEnd = a;
+        while (rEnd < removals.size() && removals[rEnd].from == static_cast<int>(u)) rEnd++;
+        while (cEnd < reweights.size() && reweights[cEnd].from == static_cast<int>(u)) cEnd++;
+        while (aEnd < appends.size() && appends[aEnd].from == static_cast<int>(u)) aEnd++;
+        if (int old = source[u]; old >= 0) {
+            for (int e = offsets[old]; e < offsets[old + 1]; e++) {
+                int t = remap[targets[e]];
+                if (t < 0) continue;
+                bool drop = false;
+                for (size_t k = r; k < rEnd && !drop; k++) drop = removals[k].to == t;
+                if (drop) continue;
+                int w = weights[e];
+                for (size_t k = c; k < cEnd; k++)
+                    if (reweights[k].to == t) w = reweights[k].weight;
+                newTargets.push_back(t);
+                newWeights.push_back(w);
+            }
+        }
+        for (size_t k = a; k < aEnd; k++) {
+            newTargets.push_back(appends[k].to);
+            newWeights.push_back(appends[k].weight);
+        }
+        newOffsets.push_back(static_cast<int>(newTargets.size()));
+        r = rEnd;
+        c = cEnd;
+        a = aEnd;
+        u++;
+    }
+
+    result.directed = directed;
+    result.vertices = move(newVertices);
+    result.offsets = move(newOffsets);
+    result.targets = move(newTargets);
+    result.weights = move(newWeights);
+    return true;
+}
+
+template<typename VertexType>
+pair<vector<VertexType>, int> FrozenGraph<VertexType>::shortest_path(VertexType start, VertexType end, bool print) const {
+    TRACE_SCOPE("graph", "frozen_shortest_path");
+    METRICS_LATENCY("frozen_shortest_path");
+
+    vector<VertexType> path;
+    int s = index_of(start);
+    int t = index_of(end);
+    if (s < 0 || t < 0) {
+        if (print)
+            cout << "No path from " << start << " to " << end << endl;
+        return { path, -1 };
+    }
+
+    const long long INF = numeric_limits<long long>::max();
+    // Per-thread scratch (one pair per page backing), so huge-page backed arrays
+    // are not mapped and unmapped on every query.
+    struct Scratch {
+        FrozenArray<long long> dist;
+        FrozenArray<int> parent;
+        explicit Scratch(PageBacking pages) : dist(PageAllocator<long long>(pages)), parent(PageAllocator<int>(pages)) {}
+    };
+    thread_local Scratch scratch[] = { Scratch(PageBacking::Default), Scratch(PageBacking::TransparentHuge),
+        Scratch(PageBacking::HugeTLB) };
+    auto& dist = scratch[static_cast<int>(backing)].dist;
+    auto& parent = scratch[static_cast<int>(backing)].parent;
+    dist.assign(vertices.size(), INF);
+    parent.assign(vertices.size(), -1);
+    dist[s] = 0;
+    parent[s] = s;
+
+    using P = pair<long long, int>;
+    priority_queue<P, vector<P>, greater<P>> pq;
+    pq.push({ 0, s });
+    vector<int> improvedVertex;
+    vector<long long> improvedDist;
+
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+
+        if (d > dist[u]) continue;
+        if (u == t) break;
+
+        int degree = offsets[u + 1] - offsets[u];
+        if (improvedVertex.size() < static_cast<size_t>(degree)) {
+            improvedVertex.resize(degree);
+            improvedDist.resize(degree);
+        }
+        int improved = relax_edges(targets.data() + offsets[u], weights.data() + offsets[u], degree, d, u,
+            dist.data(), parent.data(), improvedVertex.data(), improvedDist.data());
+        for (int i = 0; i < improved; i++)
+            pq.push({ improvedDist[i], improvedVertex[i] });
+    }
+
+    if (dist[t] == INF) {
+        if (print)
+            cout << "No path from " << start << " to " << end << endl;
+        return { path, -1 };
+    }
+
+    for (int v = t; v != s; v = parent[v])
+        path.push_back(vertices[v]);
+    path.push_back(vertices[s]);
+    reverse(path.begin(), path.end());
+
+    int totalDistance = static_cast<int>(dist[t]);
+
+    if (print) {
+        cout << "Shortest path: ";
+        for (auto const& v : path)
+            cout << v << " ";
+        cout << "\nTotal distance: " << totalDistance << "\n";
+    }
+
+    return { path, totalDistance };
+}
+
+// One in-flight search of shortest_paths_batch. dist/parent are reused between
+// queries; only the entries listed in `touched` are reset.
+template<typename VertexType>
+struct FrozenGraph<VertexType>::QueryLane {
+    enum class Phase { Idle, Pop, Relax };
+
+    FrozenArray<long long> dist;
+    FrozenArray<int> parent;
+    vector<int> touched;
+    priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> pq;
+    Phase phase = Phase::Idle;
+    size_t query = 0;
+    int source = -1, target = -1, u = -1;
+    long long du = 0;
+
+    QueryLane(size_t n, PageBacking backing)
+        : dist(n, numeric_limits<long long>::max(), PageAllocator<long long>(backing)),
+          parent(n, -1, PageAllocator<int>(backing)) {}
+
+    void start(size_t queryIndex, int s, int t) {
+        query = queryIndex;
+        source = s;
+        target = t;
+        dist[s] = 0;
+        parent[s] = s;
+        touched.push_back(s);
+        pq.push({ 0, s });
+        phase = Phase::Pop;
+    }
+
+    void reset() {
+        for (int v : touched) {
+            dist[v] = numeric_limits<long long>::max();
+            parent[v] = -1;
+        }
+        touched.clear();
+        pq = {};
+        phase = Phase::Idle;
+    }
+};
+
+template<typename VertexType>
+vector<pair<vector<VertexType>, int>> FrozenGraph<VertexType>::shortest_paths_batch(
+    const vector<pair<VertexType, VertexType>>& queries, int interleave) const {
+    TRACE_SCOPE("graph", "frozen_shortest_paths_batch");
+
+    const long long INF = numeric_limits<long long>::max();
+    vector<pair<vector<VertexType>, int>> results(queries.size(), { {}, -1 });
+    int width = max(1, min(interleave, static_cast<int>(queries.size())));
+
+    vector<QueryLane> lanes;
+    lanes.reserve(width);
+    for (int i = 0; i < width; i++)
+        lanes.emplace_back(vertices.size(), backing);
+
+    size_t nextQuery = 0;
+    auto startNext = [&](QueryLane& lane) {
+        while (nextQuery < queries.size()) {
+            size_t q = nextQuery++;
+            int s = index_of(queries[q].first);
+            int t = index_of(queries[q].second);
+            if (s >= 0 && t >= 0) {
+                lane.start(q, s, t);
+                return;
+            }
+        }
+    };
+    auto finish = [&](QueryLane& lane) {
+        if (lane.dist[lane.target] != INF) {
+            auto& [path, distance] = results[lane.query];
+            for (int v = lane.target; v != lane.source; v = lane.parent[v])
+                path.push_back(vertices[v]);
+            path.push_back(vertices[lane.source]);
+            reverse(path.begin(), path.end());
+            distance = static_cast<int>(lane.dist[lane.target]);
+        }
+        lane.reset();
+        startNext(lane);
+    };
+
+    for (auto& lane : lanes) startNext(lane);
+
+    int active = width;
+    while (active > 0) {
+        active = 0;
+        for (auto& lane : lanes) {
+            switch (lane.phase) {
+            case QueryLane::Phase::Idle:
+                continue;
+            case QueryLane::Phase::Pop:
+                // Skip stale entries, then fetch the offsets of the settled vertex.
+                while (!lane.pq.empty() && lane.pq.top().first > lane.dist[lane.pq.top().second])
+                    lane.pq.pop();
+                if (lane.pq.empty()) {
+                    finish(lane);
+                    break;
+                }
+                lane.du = lane.pq.top().first;
+                lane.u = lane.pq.top().second;
+                lane.pq.pop();
+                if (lane.u == lane.target) {
+                    finish(lane);
+                    break;
+                }
+                // offsets[u] was prefetched when u was pushed; 64-byte lines hold 16 ints.
+                for (int i = offsets[lane.u]; i < offsets[lane.u + 1]; i += 16) {
+                    FROZEN_PREFETCH(&targets[i]);
+                    FROZEN_PREFETCH(&weights[i]);
+                }
+                lane.phase = QueryLane::Phase::Relax;
+                break;
+            case QueryLane::Phase::Relax:
+                for (int i = offsets[lane.u]; i < offsets[lane.u + 1]; i++) {
+                    int v = targets[i];
+                    long long nd = lane.du + weights[i];
+                    if (nd < lane.dist[v]) {
+                        if (lane.dist[v] == INF) lane.touched.push_back(v);
+                        lane.dist[v] = nd;
+                        lane.parent[v] = lane.u;
+                        lane.pq.push({ nd, v });
+                        FROZEN_PREFETCH(&offsets[v]);
+                    }
+                }
+                lane.phase = QueryLane::Phase::Pop;
+                break;
+            }
+            if (lane.phase != QueryLane::Phase::Idle) active++;
+        }
+    }
+
+    return results;
+}
+
+template<typename VertexType>
+vector<vector<int>> FrozenGraph<VertexType>::multi_source_bfs(const vector<VertexType>& sources) const {
+    TRACE_SCOPE("graph", "multi_source_bfs");
+
+    vector<vector<int>> result(sources.size(), vector<int>(vertices.size(), -1));
+    vector<int> sourceIndices(sources.size());
+    for (size_t i = 0; i < sources.size(); i++)
+        sourceIndices[i] = index_of(sources[i]);
+
+    // The narrowest bitset that fits the remaining sources, 512 per pass at most.
+    for (size_t first = 0; first < sources.size();) {
+        size_t remaining = sources.size() - first;
+        size_t count = min<size_t>(remaining, 512);
+        if (count <= 64) multi_source_bfs_pass<1>(sourceIndices, first, count, result);
+        else if (count <= 128) multi_source_bfs_pass<2>(sourceIndices, first, count, result);
+        else if (count <= 256) multi_source_bfs_pass<4>(sourceIndices, first, count, result);
+        else multi_source_bfs_pass<8>(sourceIndices, first, count, result);
+        first += count;
+    }
+    return result;
+}
+
+template<typename VertexType>
+template<size_t Words>
+void FrozenGraph<VertexType>::multi_source_bfs_pass(const vector<int>& sourceIndices, size_t first, size_t count,
+    vector<vector<int>>& result) const {
+    // Bit i of a vertex's mask stands for source first + i. The word loops below
+    // are fixed-length and branch-free, so the compiler turns them into SIMD ops.
+    // Only the 512-source mask fills a cache line; aligning narrower ones would
+    // pad them up to 64 bytes and multiply the memory traffic of the pass.
+    struct alignas(Words >= 8 ? 64 : alignof(uint64_t)) SourceMask {
+        uint64_t w[Words] = {};
+        bool any() const {
+            uint64_t acc = 0;
+            for (size_t k = 0; k < Words; k++) acc |= w[k];
+            return acc != 0;
+        }
+    };
+
+    size_t n = vertices.size();
+    vector<SourceMask> seen(n), visit(n), visitNext(n);
+
+    for (size_t i = 0; i < count; i++) {
+        int s = sourceIndices[first + i];
+        if (s < 0) continue;
+        seen[s].w[i / 64] |= uint64_t(1) << (i % 64);
+        visit[s].w[i / 64] |= uint64_t(1) << (i % 64);
+        result[first + i][s] = 0;
+    }
+
+    for (int level = 1;; level++) {
+        bool frontier = false;
+        // Top-down step: push each vertex's frontier bits to its neighbors.
+        for (size_t v = 0; v < n; v++) {
+            if (!visit[v].any()) continue;
+            for (int e = offsets[v]; e < offsets[v + 1]; e++) {
+                SourceMask& next = visitNext[targets[e]];
+                const SourceMask& seenN = seen[targets[e]];
+                for (size_t k = 0; k < Words; k++)
+                    next.w[k] |= visit[v].w[k] & ~seenN.w[k];
+            }
+        }
+
+        // Newly reached (vertex, source) pairs get the current level.
+        for (size_t v = 0; v < n; v++) {
+            SourceMask& next = visitNext[v];
+            for (size_t k = 0; k < Words; k++) {
+                next.w[k] &= ~seen[v].w[k];
+                seen[v].w[k] |= next.w[k];
+                for (uint64_t bits = next.w[k]; bits; bits &= bits - 1) {
+                    result[first + k * 64 + frozen_lowest_bit(bits)][v] = level;
+                    frontier = true;
+                }
+            }
+        }
+
+        if (!frontier) break;
+        swap(visit, visitNext);
+        for (auto& m : visitNext) m = SourceMask();
+    }
+}
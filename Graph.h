@@ -11,6 +11,8 @@
 #include <functional>
 #include <set>
 #include <numeric>
+#include "Trace.h"
+#include "Metrics.h"
 
 using namespace std;
 
@@ -51,10 +53,13 @@ public:
 
     void add_edge(VertexType u, VertexType v, int weight = 1);
     void remove_edge(VertexType u, VertexType v);
+    // Sets the weight of every u -> v edge (and v -> u in undirected graphs).
+    void set_edge_weight(VertexType u, VertexType v, int weight);
 
     void print();
 
     const map<VertexType, list<pair<VertexType, int>>>& getAdjacency() const;
+    bool isDirected() const;
 
     // Minimum spanning tree (MST) algorithms
     pair<vector<pair<VertexType, VertexType>>, int> mst_prim(bool print);
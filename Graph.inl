@@ -39,23 +39,43 @@ void Graph<VertexType>::remove_edge(VertexType u, VertexType v) {
     }
 }
 
+template<typename VertexType>
+void Graph<VertexType>::set_edge_weight(VertexType u, VertexType v, int weight) {
+    auto update = [&](VertexType from, VertexType to) {
+        auto it = adjList.find(from);
+        if (it == adjList.end()) return;
+        for (auto& edge : it->second)
+            if (edge.first == to) edge.second = weight;
+    };
+    update(u, v);
+    if (!directed && u != v)
+        update(v, u);
+}
+
 template<typename VertexType>
 const map<VertexType, list<pair<VertexType, int>>>& Graph<VertexType>::getAdjacency() const {
     return adjList;
 }
 
+template<typename VertexType>
+bool Graph<VertexType>::isDirected() const {
+    return directed;
+}
+
 template<typename VertexType>
 void Graph<VertexType>::print() {
     for (auto const& [vertex, neighbors] : adjList) {
         cout << vertex << " -> ";
         for (auto const& [to, w] : neighbors)
             cout << "(" << to << ", " << w << ") ";
-        cout << endl;
+        cout << '\n';
     }
+    cout << flush;
 }
 
 template<typename VertexType>
 pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_prim(bool print) {
+    TRACE_SCOPE("graph", "mst_prim");
     vector<pair<VertexType, VertexType>> mstEdges;
     int totalWeight = 0;
 
@@ -108,6 +128,7 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_prim(bool
 
 template<typename VertexType>
 pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_kruskal(bool print) {
+    TRACE_SCOPE("graph", "mst_kruskal");
     vector<pair<VertexType, VertexType>> mstEdges;
     int totalWeight = 0;
 
@@ -121,18 +142,24 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_kruskal(b
     }
 
     vector<tuple<int, VertexType, VertexType>> edges;
-    set<pair<VertexType, VertexType>> usedEdges;
-    for (const auto& [u, neighbors] : adjList) {
-        for (const auto& [v, w] : neighbors) {
-            if (u != v && usedEdges.find({ v, u }) == usedEdges.end()) {
-                edges.emplace_back(w, u, v);
-                usedEdges.insert({ u, v });
+    {
+        TRACE_SCOPE("graph", "collect_edges");
+        set<pair<VertexType, VertexType>> usedEdges;
+        for (const auto& [u, neighbors] : adjList) {
+            for (const auto& [v, w] : neighbors) {
+                if (u != v && usedEdges.find({ v, u }) == usedEdges.end()) {
+                    edges.emplace_back(w, u, v);
+                    usedEdges.insert({ u, v });
+                }
             }
         }
     }
 
-    sort(edges.begin(), edges.end(),
-        [](auto const& a, auto const& b) { return get<0>(a) < get<0>(b); });
+    {
+        TRACE_SCOPE("graph", "sort_edges");
+        sort(edges.begin(), edges.end(),
+            [](auto const& a, auto const& b) { return get<0>(a) < get<0>(b); });
+    }
 
     map<VertexType, int> vertexToIndex;
     int idx = 0;
@@ -141,13 +168,16 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_kruskal(b
 
     DSU<VertexType> dsu(idx);
 
-    for (auto& [w, u, v] : edges) {
-        int setU = dsu.find_set(vertexToIndex[u]);
-        int setV = dsu.find_set(vertexToIndex[v]);
-        if (setU != setV) {
-            dsu.union_sets(setU, setV);
-            mstEdges.push_back({ u, v });
-            totalWeight += w;
+    {
+        TRACE_SCOPE("graph", "union_edges");
+        for (auto& [w, u, v] : edges) {
+            int setU = dsu.find_set(vertexToIndex[u]);
+            int setV = dsu.find_set(vertexToIndex[v]);
+            if (setU != setV) {
+                dsu.union_sets(setU, setV);
+                mstEdges.push_back({ u, v });
+                totalWeight += w;
+            }
         }
     }
 
@@ -163,6 +193,7 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_kruskal(b
 
 template<typename VertexType>
 pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_boruvka(bool print) {
+    TRACE_SCOPE("graph", "mst_boruvka");
     vector<pair<VertexType, VertexType>> mstEdges;
     int totalWeight = 0;
 
@@ -178,12 +209,15 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_boruvka(b
     }
 
     vector<tuple<int, VertexType, VertexType>> edges;
-    set<pair<VertexType, VertexType>> usedEdges;
-    for (const auto& [u, neighbors] : adjList) {
-        for (const auto& [v, w] : neighbors) {
-            if (u != v && usedEdges.find({ v, u }) == usedEdges.end()) {
-                edges.emplace_back(w, u, v);
-                usedEdges.insert({ u, v });
+    {
+        TRACE_SCOPE("graph", "collect_edges");
+        set<pair<VertexType, VertexType>> usedEdges;
+        for (const auto& [u, neighbors] : adjList) {
+            for (const auto& [v, w] : neighbors) {
+                if (u != v && usedEdges.find({ v, u }) == usedEdges.end()) {
+                    edges.emplace_back(w, u, v);
+                    usedEdges.insert({ u, v });
+                }
             }
         }
     }
@@ -198,6 +232,7 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_boruvka(b
     int numTrees = V;
 
     while (numTrees > 1) {
+        TRACE_SCOPE("graph", "boruvka_round");
         vector<int> cheapest(idx, -1);
 
         for (int i = 0; i < static_cast<int>(edges.size()); i++) {
@@ -246,6 +281,8 @@ pair<vector<pair<VertexType, VertexType>>, int> Graph<VertexType>::mst_boruvka(b
 
 template<typename VertexType>
 pair<vector<VertexType>, int> Graph<VertexType>::shortest_path(VertexType start, VertexType end, bool print) {
+    TRACE_SCOPE("graph", "shortest_path");
+    METRICS_LATENCY("shortest_path");
     map<VertexType, double> dist;
     map<VertexType, VertexType> parent;
 
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+// Difference between two versions of a Graph, applied in this order: remove
+// vertices (with all their edges), remove edges (every u -> v edge, and v -> u
+// for undirected graphs, like Graph::remove_edge), set weights (of every u -> v
+// edge), add vertices, add edges (appended like Graph::add_edge, which also adds
+// missing endpoints). Undirected edges are listed once.
+//
+// fromVersion / toVersion are not interpreted here; they let a replica check
+// that a patch continues the version it holds.
+template<typename VertexType>
+struct GraphDelta {
+    bool directed = false;
+    uint64_t fromVersion = 0;
+    uint64_t toVersion = 0;
+    vector<VertexType> removedVertices;
+    vector<pair<VertexType, VertexType>> removedEdges;
+    vector<tuple<VertexType, VertexType, int>> changedWeights;
+    vector<VertexType> addedVertices;
+    vector<tuple<VertexType, VertexType, int>> addedEdges;
+
+    bool empty() const {
+        return removedVertices.empty() && removedEdges.empty() && changedWeights.empty() &&
+            addedVertices.empty() && addedEdges.empty();
+    }
+};
+
+// Delta that turns `from` into `to` (both must have the same directedness).
+// Unchanged adjacency lists are skipped after one comparison. Between a pair
+// of vertices, extra parallel edges are added, equal-count edges with one new
+// weight become a weight change, anything else is removed and re-added.
+// Applying the result gives `to` up to the order of neighbors of changed vertices.
+template<typename VertexType>
+GraphDelta<VertexType> diff_graphs(const Graph<VertexType>& from, const Graph<VertexType>& to);
+
+// Applies the delta in place; false (and g unchanged) if the directedness differs.
+// FrozenGraph::patch applies a delta to a frozen snapshot.
+template<typename VertexType>
+bool apply_delta(Graph<VertexType>& g, const GraphDelta<VertexType>& delta);
+
+// Compact binary patch (integral vertex types): "GDL1", then LEB128 varints for
+// the flags, the versions and each list, with vertex ids delta coded against
+// the previous entry, edge targets against their source and everything zigzag
+// encoded. Edits of neighboring vertices cost a few bytes each.
+template<typename VertexType>
+string encode_graph_delta(const GraphDelta<VertexType>& delta);
+// False if the patch is truncated or malformed.
+template<typename VertexType>
+bool decode_graph_delta(string_view patch, GraphDelta<VertexType>& delta);
+
+#include "GraphDelta.inl"
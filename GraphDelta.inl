@@ -0,0 +1,229 @@
+#include "GraphDelta.h"
+
+namespace graph_delta_detail {
+    constexpr char Magic[4] = { 'G', 'D', 'L', '1' };
+
+    inline void putVarint(string& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    inline bool getVarint(string_view in, size_t& pos, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            uint8_t b = static_cast<uint8_t>(in[pos++]);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // Differences are taken modulo 2^64, so any integral vertex type round-trips.
+    inline uint64_t zigzag(uint64_t d) { return (d << 1) ^ (0 - (d >> 63)); }
+    inline uint64_t unzigzag(uint64_t z) { return (z >> 1) ^ (0 - (z & 1)); }
+
+    // Records the change of the u -> t edges from `before` to `after` (weights in
+    // adjacency order).
+    template<typename VertexType>
+    void diffEdges(const VertexType& u, const VertexType& t, const vector<int>& before, const vector<int>& after,
+        GraphDelta<VertexType>& delta) {
+        size_t kept = before.size() <= after.size() && equal(before.begin(), before.end(), after.begin())
+            ? before.size() : 0;
+        if (kept == 0 && !before.empty()) {
+            if (before.size() == after.size() &&
+                all_of(after.begin(), after.end(), [&](int w) { return w == after[0]; })) {
+                delta.changedWeights.emplace_back(u, t, after[0]);
+                return;
+            }
+            delta.removedEdges.emplace_back(u, t);
+        }
+        for (size_t i = kept; i < after.size(); i++)
+            delta.addedEdges.emplace_back(u, t, after[i]);
+    }
+}
+
+template<typename VertexType>
+GraphDelta<VertexType> diff_graphs(const Graph<VertexType>& from, const Graph<VertexType>& to) {
+    TRACE_SCOPE("graph", "diff_graphs");
+    using Arc = pair<VertexType, int>;
+
+    GraphDelta<VertexType> delta;
+    delta.directed = to.isDirected();
+    auto const& a = from.getAdjacency();
+    auto const& b = to.getAdjacency();
+    const list<Arc> none;
+
+    // Arcs of u grouped by target (parallel edges keep their order). Undirected
+    // edges are recorded from the smaller endpoint; arcs to removed vertices go
+    // away with the vertex.
+    vector<Arc> before, after;
+    auto collect = [&](const VertexType& u, const list<Arc>& arcs, vector<Arc>& out) {
+        out.clear();
+        for (auto const& arc : arcs)
+            if ((delta.directed || !(arc.first < u)) && b.count(arc.first)) out.push_back(arc);
+        stable_sort(out.begin(), out.end(), [](const Arc& x, const Arc& y) { return x.first < y.first; });
+    };
+
+    vector<int> weightsBefore, weightsAfter;
+    auto ia = a.begin();
+    for (auto ib = b.begin(); ia != a.end() || ib != b.end();) {
+        if (ib == b.end() || (ia != a.end() && ia->first < ib->first)) {
+            delta.removedVertices.push_back(ia->first);
+            ++ia;
+            continue;
+        }
+        const VertexType& u = ib->first;
+        bool known = ia != a.end() && !(u < ia->first);
+        if (!known) delta.addedVertices.push_back(u);
+        if (!known || ia->second != ib->second) {
+            collect(u, known ? ia->second : none, before);
+            collect(u, ib->second, after);
+            size_t i = 0, j = 0;
+            while (i < before.size() || j < after.size()) {
+                VertexType t = j == after.size() || (i < before.size() && before[i].first < after[j].first)
+                    ? before[i].first : after[j].first;
+                weightsBefore.clear();
+                weightsAfter.clear();
+                for (; i < before.size() && before[i].first == t; i++) weightsBefore.push_back(before[i].second);
+                for (; j < after.size() && after[j].first == t; j++) weightsAfter.push_back(after[j].second);
+                graph_delta_detail::diffEdges(u, t, weightsBefore, weightsAfter, delta);
+            }
+        }
+        if (known) ++ia;
+        ++ib;
+    }
+    return delta;
+}
+
+template<typename VertexType>
+bool apply_delta(Graph<VertexType>& g, const GraphDelta<VertexType>& delta) {
+    TRACE_SCOPE("graph", "apply_delta");
+    if (delta.directed != g.isDirected()) return false;
+    for (auto const& v : delta.removedVertices)
+        g.remove_vertex(v);
+    for (auto const& [u, v] : delta.removedEdges)
+        g.remove_edge(u, v);
+    for (auto const& [u, v, w] : delta.changedWeights)
+        g.set_edge_weight(u, v, w);
+    for (auto const& v : delta.addedVertices)
+        g.add_vertex(v);
+    for (auto const& [u, v, w] : delta.addedEdges)
+        g.add_edge(u, v, w);
+    return true;
+}
+
+template<typename VertexType>
+string encode_graph_delta(const GraphDelta<VertexType>& delta) {
+    static_assert(is_integral_v<VertexType>, "binary patches need integral vertex ids");
+    using namespace graph_delta_detail;
+
+    string out(Magic, sizeof(Magic));
+    putVarint(out, delta.directed ? 1 : 0);
+    putVarint(out, delta.fromVersion);
+    putVarint(out, delta.toVersion);
+
+    uint64_t previous = 0;
+    auto putVertex = [&](VertexType v) {
+        putVarint(out, zigzag(static_cast<uint64_t>(v) - previous));
+        previous = static_cast<uint64_t>(v);
+    };
+    auto putTarget = [&](VertexType u, VertexType v) {
+        putVarint(out, zigzag(static_cast<uint64_t>(v) - static_cast<uint64_t>(u)));
+    };
+    auto putWeight = [&](int w) { putVarint(out, zigzag(static_cast<uint64_t>(static_cast<int64_t>(w)))); };
+
+    putVarint(out, delta.removedVertices.size());
+    for (VertexType v : delta.removedVertices) putVertex(v);
+    previous = 0;
+    putVarint(out, delta.removedEdges.size());
+    for (auto const& [u, v] : delta.removedEdges) {
+        putVertex(u);
+        putTarget(u, v);
+    }
+    previous = 0;
+    putVarint(out, delta.changedWeights.size());
+    for (auto const& [u, v, w] : delta.changedWeights) {
+        putVertex(u);
+        putTarget(u, v);
+        putWeight(w);
+    }
+    previous = 0;
+    putVarint(out, delta.addedVertices.size());
+    for (VertexType v : delta.addedVertices) putVertex(v);
+    previous = 0;
+    putVarint(out, delta.addedEdges.size());
+    for (auto const& [u, v, w] : delta.addedEdges) {
+        putVertex(u);
+        putTarget(u, v);
+        putWeight(w);
+    }
+    return out;
+}
+
+template<typename VertexType>
+bool decode_graph_delta(string_view patch, GraphDelta<VertexType>& delta) {
+    static_assert(is_integral_v<VertexType>, "binary patches need integral vertex ids");
+    using namespace graph_delta_detail;
+
+    if (patch.size() < sizeof(Magic) || patch.substr(0, sizeof(Magic)) != string_view(Magic, sizeof(Magic)))
+        return false;
+    size_t pos = sizeof(Magic);
+    uint64_t previous = 0, value = 0;
+    auto get = [&](uint64_t& v) { return getVarint(patch, pos, v); };
+    // Every entry takes at least one byte, which bounds the counts.
+    auto getCount = [&](uint64_t& count) {
+        previous = 0;
+        return get(count) && count <= patch.size() - pos;
+    };
+    auto getVertex = [&](VertexType& v) {
+        if (!get(value)) return false;
+        previous += unzigzag(value);
+        v = static_cast<VertexType>(previous);
+        return true;
+    };
+    auto getTarget = [&](VertexType u, VertexType& v) {
+        if (!get(value)) return false;
+        v = static_cast<VertexType>(static_cast<uint64_t>(u) + unzigzag(value));
+        return true;
+    };
+    auto getWeight = [&](int& w) {
+        if (!get(value)) return false;
+        int64_t weight = static_cast<int64_t>(unzigzag(value));
+        if (weight < numeric_limits<int>::min() || weight > numeric_limits<int>::max()) return false;
+        w = static_cast<int>(weight);
+        return true;
+    };
+
+    GraphDelta<VertexType> result;
+    uint64_t flags, count;
+    if (!get(flags) || flags > 1 || !get(result.fromVersion) || !get(result.toVersion)) return false;
+    result.directed = flags == 1;
+
+    if (!getCount(count)) return false;
+    result.removedVertices.resize(static_cast<size_t>(count));
+    for (auto& v : result.removedVertices)
+        if (!getVertex(v)) return false;
+    if (!getCount(count)) return false;
+    result.removedEdges.resize(static_cast<size_t>(count));
+    for (auto& [u, v] : result.removedEdges)
+        if (!getVertex(u) || !getTarget(u, v)) return false;
+    if (!getCount(count)) return false;
+    result.changedWeights.resize(static_cast<size_t>(count));
+    for (auto& [u, v, w] : result.changedWeights)
+        if (!getVertex(u) || !getTarget(u, v) || !getWeight(w)) return false;
+    if (!getCount(count)) return false;
+    result.addedVertices.resize(static_cast<size_t>(count));
+    for (auto& v : result.addedVertices)
+        if (!getVertex(v)) return false;
+    if (!getCount(count)) return false;
+    result.addedEdges.resize(static_cast<size_t>(count));
+    for (auto& [u, v, w] : result.addedEdges)
+        if (!getVertex(u) || !getTarget(u, v) || !getWeight(w)) return false;
+
+    if (pos != patch.size()) return false;
+    delta = move(result);
+    return true;
+}
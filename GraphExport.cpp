@@ -0,0 +1,114 @@
+#include "GraphExport.h"
+#include <cerrno>
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+void ExportBuffer::putXmlEscaped(string_view s) {
+    for (char c : s) {
+        switch (c) {
+        case '<': put("&lt;"); break;
+        case '>': put("&gt;"); break;
+        case '&': put("&amp;"); break;
+        case '"': put("&quot;"); break;
+        case '\'': put("&apos;"); break;
+        default: put(c);
+        }
+    }
+}
+
+void ExportBuffer::putJsonEscaped(string_view s) {
+    static const char Hex[] = "0123456789abcdef";
+    for (char c : s) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put(c);
+        }
+        else if (u < 0x20) {
+            put("\\u00");
+            put(Hex[u >> 4]);
+            put(Hex[u & 15]);
+        }
+        else {
+            put(c);
+        }
+    }
+}
+
+void ExportBuffer::putDotEscaped(string_view s) {
+    for (char c : s) {
+        if (c == '"' || c == '\\') put('\\');
+        if (c == '\n') {
+            put("\\n");
+            continue;
+        }
+        put(c);
+    }
+}
+
+ExportSink::ExportSink(const string& path) {
+#ifdef __linux__
+    fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    good = fd >= 0;
+#else
+    file = fopen(path.c_str(), "wb");
+    if (file) setvbuf(file, nullptr, _IONBF, 0); // chunks are already large
+    good = file != nullptr;
+#endif
+}
+
+ExportSink::ExportSink(string& target) : memory(&target), start(target.size()) {}
+
+ExportSink::~ExportSink() { finish(); }
+
+void ExportSink::write(const char* bytes, size_t count) {
+    if (!good || count == 0) return;
+    total += count;
+    if (memory) {
+        memory->append(bytes, count);
+        return;
+    }
+#ifdef __linux__
+    while (count > 0) {
+        ssize_t written = ::write(fd, bytes, count);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            good = false;
+            return;
+        }
+        bytes += written;
+        count -= static_cast<size_t>(written);
+    }
+#else
+    if (fwrite(bytes, 1, count, file) != count) good = false;
+#endif
+}
+
+void ExportSink::patch(size_t offset, const char* bytes, size_t count) {
+    if (!good) return;
+    if (memory) {
+        memory->replace(start + offset, count, bytes, count);
+        return;
+    }
+#ifdef __linux__
+    if (pwrite(fd, bytes, count, static_cast<off_t>(offset)) != static_cast<ssize_t>(count)) good = false;
+#else
+    long end = ftell(file);
+    if (fseek(file, static_cast<long>(offset), SEEK_SET) != 0 || fwrite(bytes, 1, count, file) != count
+        || fseek(file, end, SEEK_SET) != 0)
+        good = false;
+#endif
+}
+
+bool ExportSink::finish() {
+#ifdef __linux__
+    if (fd >= 0 && ::close(fd) != 0) good = false;
+    fd = -1;
+#endif
+    if (file && fclose(file) != 0) good = false;
+    file = nullptr;
+    return good;
+}
@@ -0,0 +1,107 @@
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+enum class GraphFormat {
+    Dot,            // Graphviz; edge weights as `weight` attributes
+    GraphML,        // XML with an int edge attribute "weight"
+    Json,           // {"directed":…,"nodes":[…],"edges":[{"source":…,"target":…,"weight":…}]}
+    BinaryEdgeList  // see below; integral vertex types only
+};
+
+// Binary edge list layout (host byte order, little-endian on all supported targets):
+//   char magic[4] = "GEL1", uint32 flags (bit 0 = directed), uint64 edgeCount,
+//   then edgeCount records of { int64 from, int64 to, int32 weight } (20 bytes, packed).
+// Undirected edges are stored once.
+constexpr char BinaryEdgeListMagic[4] = { 'G', 'E', 'L', '1' };
+constexpr size_t BinaryEdgeRecordSize = 20;
+
+// Bytes assembled for one chunk of the output. The storage is kept across
+// clear() and grown geometrically, so appends are a bounds check and a memcpy;
+// numbers are formatted with to_chars straight into it (no locale or stream state).
+class ExportBuffer {
+public:
+    void clear() { length = 0; }
+    size_t size() const { return length; }
+    string_view view() const { return string_view(data.data(), length); }
+
+    void put(char c) { *grow(1) = c; }
+    void put(string_view s) { memcpy(grow(s.size()), s.data(), s.size()); }
+    template<typename Int>
+    void putInt(Int value) {
+        char* out = grow(MaxIntChars);
+        length -= MaxIntChars - static_cast<size_t>(to_chars(out, out + MaxIntChars, value).ptr - out);
+    }
+    // Raw host-order bytes of an integer (binary formats).
+    template<typename Int>
+    void putRaw(Int value) { memcpy(grow(sizeof(value)), &value, sizeof(value)); }
+
+    void putXmlEscaped(string_view s);
+    void putJsonEscaped(string_view s);  // without the surrounding quotes
+    void putDotEscaped(string_view s);   // same
+
+private:
+    static constexpr size_t MaxIntChars = 24;
+
+    // Reserves n bytes at the end and returns where they start.
+    char* grow(size_t n) {
+        if (length + n > data.size()) data.resize(max(data.size() * 2, max<size_t>(length + n, 4096)));
+        char* p = &data[length];
+        length += n;
+        return p;
+    }
+
+    string data;
+    size_t length = 0;
+};
+
+// Destination of an export: a file written with large unbuffered writes (write(2)
+// on POSIX), or an in-memory string.
+class ExportSink {
+public:
+    explicit ExportSink(const string& path);
+    explicit ExportSink(string& target);
+    ~ExportSink();
+    ExportSink(const ExportSink&) = delete;
+    ExportSink& operator=(const ExportSink&) = delete;
+
+    bool ok() const { return good; }
+    void write(const char* bytes, size_t count);
+    void write(string_view s) { write(s.data(), s.size()); }
+    // Overwrites bytes already written (e.g. a count known only at the end).
+    void patch(size_t offset, const char* bytes, size_t count);
+    size_t written() const { return total; }
+    // Flushes and closes the file; false if any write failed.
+    bool finish();
+
+private:
+    int fd = -1;
+    FILE* file = nullptr;
+    string* memory = nullptr;
+    size_t start = 0; // offset of the export within *memory
+    size_t total = 0;
+    bool good = true;
+};
+
+// Streams the graph in the given format. Vertices are formatted in blocks; with
+// threads > 1 each block is split into vertex ranges that are formatted in
+// parallel and written in order, so the output is identical for every thread
+// count. Memory use is bounded by the block size, not the graph size.
+// Returns false if the file cannot be written, or for BinaryEdgeList with a
+// non-integral vertex type.
+template<typename VertexType>
+bool export_graph(const Graph<VertexType>& g, const string& path, GraphFormat format, int threads = 1);
+
+// Same, into a string.
+template<typename VertexType>
+string export_graph(const Graph<VertexType>& g, GraphFormat format, int threads = 1);
+
+#include "GraphExport.inl"
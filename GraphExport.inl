@@ -0,0 +1,213 @@
+#include "GraphExport.h"
+#include <sstream>
+#include <type_traits>
+
+namespace graph_export_detail {
+    // Vertices formatted per block; bounds the memory held by the chunk buffers.
+    constexpr size_t BlockVertices = size_t(1) << 16;
+
+    template<typename VertexType>
+    using Entry = const pair<const VertexType, list<pair<VertexType, int>>>*;
+
+    template<typename VertexType>
+    void putVertex(ExportBuffer& out, const VertexType& v, GraphFormat format) {
+        if constexpr (is_integral_v<VertexType>) {
+            out.putInt(v);
+        }
+        else {
+            string text;
+            if constexpr (is_convertible_v<const VertexType&, string_view>) {
+                text = string(string_view(v));
+            }
+            else {
+                ostringstream s;
+                s << v;
+                text = s.str();
+            }
+            if (format == GraphFormat::GraphML) {
+                out.putXmlEscaped(text);
+                return;
+            }
+            out.put('"');
+            if (format == GraphFormat::Json) out.putJsonEscaped(text);
+            else out.putDotEscaped(text);
+            out.put('"');
+        }
+    }
+
+    // An undirected edge is listed by both endpoints; only the copy with from <= to is kept.
+    template<typename VertexType>
+    bool keepEdge(bool directed, const VertexType& from, const VertexType& to) {
+        return directed || !(to < from);
+    }
+
+    // Calls formatRange(buffer, first, last) for the vertex entries in blocks, split
+    // over `threads` workers, and writes the buffers in order. With commaSeparated,
+    // every element is written with a leading ',' and the first one of the whole
+    // sequence is dropped, so chunks do not need to know what came before them.
+    template<typename VertexType, typename FormatRange>
+    void writeRanges(const vector<Entry<VertexType>>& entries, ExportSink& sink, int threads,
+        bool commaSeparated, vector<ExportBuffer>& buffers, FormatRange&& formatRange) {
+        bool first = true;
+        for (size_t block = 0; block < entries.size(); block += BlockVertices) {
+            size_t blockEnd = min(entries.size(), block + BlockVertices);
+            size_t count = blockEnd - block;
+            int parts = static_cast<int>(min<size_t>(static_cast<size_t>(max(1, threads)), (count + 1023) / 1024));
+            if (buffers.size() < static_cast<size_t>(parts)) buffers.resize(parts);
+            auto run = [&](int part) {
+                buffers[part].clear();
+                formatRange(buffers[part], block + count * part / parts, block + count * (part + 1) / parts);
+            };
+            vector<thread> workers;
+            for (int part = 1; part < parts; part++) workers.emplace_back(run, part);
+            run(0);
+            for (auto& w : workers) w.join();
+
+            for (int part = 0; part < parts; part++) {
+                string_view text = buffers[part].view();
+                if (text.empty()) continue;
+                size_t skip = commaSeparated && first ? 1 : 0;
+                sink.write(text.data() + skip, text.size() - skip);
+                first = false;
+            }
+        }
+    }
+
+    template<typename VertexType>
+    bool writeGraph(const Graph<VertexType>& g, ExportSink& sink, GraphFormat format, int threads) {
+        if (format == GraphFormat::BinaryEdgeList && !is_integral_v<VertexType>) return false;
+        if (!sink.ok()) return false;
+
+        auto const& adjacency = g.getAdjacency();
+        vector<Entry<VertexType>> entries;
+        entries.reserve(adjacency.size());
+        for (auto const& entry : adjacency) entries.push_back(&entry);
+        bool directed = g.isDirected();
+        vector<ExportBuffer> buffers;
+
+        auto forEdges = [&](size_t first, size_t last, auto&& fn) {
+            for (size_t i = first; i < last; i++) {
+                auto const& [from, neighbors] = *entries[i];
+                for (auto const& [to, weight] : neighbors)
+                    if (keepEdge(directed, from, to)) fn(from, to, weight);
+            }
+        };
+        auto nodesPass = [&](bool commaSeparated, auto&& fn) {
+            writeRanges<VertexType>(entries, sink, threads, commaSeparated, buffers,
+                [&](ExportBuffer& out, size_t first, size_t last) {
+                    for (size_t i = first; i < last; i++) fn(out, *entries[i]);
+                });
+        };
+        auto edgesPass = [&](bool commaSeparated, auto&& fn) {
+            writeRanges<VertexType>(entries, sink, threads, commaSeparated, buffers,
+                [&](ExportBuffer& out, size_t first, size_t last) {
+                    forEdges(first, last, [&](const VertexType& from, const VertexType& to, int weight) { fn(out, from, to, weight); });
+                });
+        };
+
+        switch (format) {
+        case GraphFormat::Dot: {
+            sink.write(directed ? "digraph G {\n" : "graph G {\n");
+            string_view arrow = directed ? " -> " : " -- ";
+            writeRanges<VertexType>(entries, sink, threads, false, buffers,
+                [&](ExportBuffer& out, size_t first, size_t last) {
+                    for (size_t i = first; i < last; i++) {
+                        auto const& [from, neighbors] = *entries[i];
+                        // Vertices without edges of their own would not appear otherwise.
+                        if (neighbors.empty()) {
+                            out.put("  ");
+                            putVertex(out, from, format);
+                            out.put(";\n");
+                        }
+                        forEdges(i, i + 1, [&](const VertexType& from, const VertexType& to, int weight) {
+                            out.put("  ");
+                            putVertex(out, from, format);
+                            out.put(arrow);
+                            putVertex(out, to, format);
+                            out.put(" [weight=");
+                            out.putInt(weight);
+                            out.put("];\n");
+                        });
+                    }
+                });
+            sink.write("}\n");
+            break;
+        }
+        case GraphFormat::GraphML:
+            sink.write(
+                "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+                "<graphml xmlns=\"http://graphml.graphdrawing.org/xmlns\">\n"
+                "  <key id=\"weight\" for=\"edge\" attr.name=\"weight\" attr.type=\"int\"/>\n");
+            sink.write(directed ? "  <graph id=\"G\" edgedefault=\"directed\">\n"
+                                : "  <graph id=\"G\" edgedefault=\"undirected\">\n");
+            nodesPass(false, [&](ExportBuffer& out, auto const& entry) {
+                out.put("    <node id=\"");
+                putVertex(out, entry.first, format);
+                out.put("\"/>\n");
+            });
+            edgesPass(false, [&](ExportBuffer& out, const VertexType& from, const VertexType& to, int weight) {
+                out.put("    <edge source=\"");
+                putVertex(out, from, format);
+                out.put("\" target=\"");
+                putVertex(out, to, format);
+                out.put("\"><data key=\"weight\">");
+                out.putInt(weight);
+                out.put("</data></edge>\n");
+            });
+            sink.write("  </graph>\n</graphml>\n");
+            break;
+        case GraphFormat::Json:
+            sink.write(directed ? "{\"directed\":true,\"nodes\":[" : "{\"directed\":false,\"nodes\":[");
+            nodesPass(true, [&](ExportBuffer& out, auto const& entry) {
+                out.put(',');
+                putVertex(out, entry.first, format);
+            });
+            sink.write("],\"edges\":[");
+            edgesPass(true, [&](ExportBuffer& out, const VertexType& from, const VertexType& to, int weight) {
+                out.put(",{\"source\":");
+                putVertex(out, from, format);
+                out.put(",\"target\":");
+                putVertex(out, to, format);
+                out.put(",\"weight\":");
+                out.putInt(weight);
+                out.put('}');
+            });
+            sink.write("]}\n");
+            break;
+        case GraphFormat::BinaryEdgeList:
+            if constexpr (is_integral_v<VertexType>) {
+                // The edge count is patched in at the end instead of counting in an extra pass.
+                ExportBuffer header;
+                header.put(string_view(BinaryEdgeListMagic, sizeof(BinaryEdgeListMagic)));
+                header.putRaw(static_cast<uint32_t>(directed ? 1 : 0));
+                header.putRaw(uint64_t(0));
+                sink.write(header.view());
+                edgesPass(false, [&](ExportBuffer& out, const VertexType& from, const VertexType& to, int weight) {
+                    out.putRaw(static_cast<int64_t>(from));
+                    out.putRaw(static_cast<int64_t>(to));
+                    out.putRaw(static_cast<int32_t>(weight));
+                });
+                uint64_t edgeCount = (sink.written() - header.size()) / BinaryEdgeRecordSize;
+                sink.patch(8, reinterpret_cast<const char*>(&edgeCount), sizeof(edgeCount));
+            }
+            break;
+        }
+        return sink.finish();
+    }
+}
+
+template<typename VertexType>
+bool export_graph(const Graph<VertexType>& g, const string& path, GraphFormat format, int threads) {
+    TRACE_SCOPE("graph", "export_graph");
+    ExportSink sink(path);
+    return graph_export_detail::writeGraph(g, sink, format, threads);
+}
+
+template<typename VertexType>
+string export_graph(const Graph<VertexType>& g, GraphFormat format, int threads) {
+    TRACE_SCOPE("graph", "export_graph");
+    string result;
+    ExportSink sink(result);
+    graph_export_detail::writeGraph(g, sink, format, threads);
+    return result;
+}
@@ -0,0 +1,136 @@
+#include "Heatmap.h"
+#include "Trace.h"
+using namespace std;
+
+namespace {
+    atomic<size_t> nextCountersId{ 0 };
+
+    // Calls task(begin, end, worker) for up to `threads` contiguous slices of [0, count).
+    template<typename Task>
+    void parallelSlices(size_t count, int threads, Task&& task) {
+        threads = max(1, min(threads, static_cast<int>(count / 4096) + 1));
+        vector<thread> workers;
+        for (int t = 1; t < threads; t++)
+            workers.emplace_back([&, t]() { task(count * t / threads, count * (t + 1) / threads, t); });
+        task(0, count / threads, 0);
+        for (auto& w : workers) w.join();
+    }
+
+    int roundUpToPowerOfTwo(int value) {
+        int result = 1;
+        while (result < value) result <<= 1;
+        return result;
+    }
+}
+
+ShardedCounters::ShardedCounters(size_t counterCount)
+    : count(counterCount), id(nextCountersId++), pool(make_shared<ShardPool>()) {}
+
+ShardedCounters::ThreadShards::~ThreadShards() {
+    for (auto& [weakPool, shard] : owned) {
+        if (auto p = weakPool.lock()) {
+            lock_guard<mutex> lock(p->lock);
+            p->freeShards.push_back(shard);
+        }
+    }
+}
+
+size_t ShardedCounters::shardCount() const {
+    lock_guard<mutex> lock(pool->lock);
+    return pool->threadShards.size() + pool->workerShards.size();
+}
+
+// Callers hold pool->lock.
+atomic<uint64_t>* ShardedCounters::addShard(vector<Shard>& list) {
+    list.emplace_back(new atomic<uint64_t>[count]);
+    for (size_t i = 0; i < count; i++) list.back()[i].store(0, memory_order_relaxed);
+    return list.back().get();
+}
+
+atomic<uint64_t>* ShardedCounters::localShardSlow(ThreadShards& local) {
+    atomic<uint64_t>* shard;
+    {
+        lock_guard<mutex> lock(pool->lock);
+        if (pool->freeShards.empty()) {
+            shard = addShard(pool->threadShards);
+        } else {
+            shard = pool->freeShards.back();
+            pool->freeShards.pop_back();
+        }
+    }
+    local.owned.emplace_back(pool, shard);
+    return shard;
+}
+
+atomic<uint64_t>* ShardedCounters::batchShard(int worker) {
+    lock_guard<mutex> lock(pool->lock);
+    while (static_cast<int>(pool->workerShards.size()) <= worker) addShard(pool->workerShards);
+    return pool->workerShards[worker].get();
+}
+
+vector<uint64_t> ShardedCounters::snapshot(int threads) const {
+    vector<uint64_t> total(count, 0);
+    lock_guard<mutex> lock(pool->lock);
+    parallelSlices(count, threads, [&](size_t begin, size_t end, int) {
+        for (auto const* list : { &pool->threadShards, &pool->workerShards })
+            for (auto const& shard : *list)
+                for (size_t i = begin; i < end; i++) total[i] += shard[i].load(memory_order_relaxed);
+    });
+    return total;
+}
+
+void ShardedCounters::reset() {
+    lock_guard<mutex> lock(pool->lock);
+    for (auto* list : { &pool->threadShards, &pool->workerShards })
+        for (auto& shard : *list)
+            for (size_t i = 0; i < count; i++) shard[i].store(0, memory_order_relaxed);
+}
+
+Heatmap::Heatmap(double minX, double minY, double maxX, double maxY, int resolution)
+    : minX(minX), minY(minY), resolution(roundUpToPowerOfTwo(resolution)),
+      counters(static_cast<size_t>(this->resolution) * this->resolution) {
+    levels = 1;
+    while ((1 << (levels - 1)) < this->resolution) levels++;
+    scaleX = maxX > minX ? this->resolution / (maxX - minX) : 0;
+    scaleY = maxY > minY ? this->resolution / (maxY - minY) : 0;
+}
+
+void Heatmap::recordBatch(const FleetPositions& fleet, int threads) {
+    TRACE_SCOPE("heatmap", "record_batch");
+    size_t n = min(fleet.x.size(), fleet.y.size());
+    threads = max(1, min(threads, static_cast<int>(n / 4096) + 1));
+    vector<atomic<uint64_t>*> shards(threads);
+    for (int t = 0; t < threads; t++) shards[t] = counters.batchShard(t);
+    parallelSlices(n, threads, [&](size_t begin, size_t end, int worker) {
+        atomic<uint64_t>* shard = shards[worker];
+        for (size_t i = begin; i < end; i++) ShardedCounters::bump(shard[cellOf(fleet.x[i], fleet.y[i])], 1);
+    });
+}
+
+vector<vector<uint64_t>> Heatmap::pyramid(int threads) const {
+    TRACE_SCOPE("heatmap", "pyramid");
+    vector<vector<uint64_t>> result;
+    result.push_back(counters.snapshot(threads));
+    for (int k = 1; k < levels; k++) {
+        const vector<uint64_t>& finer = result.back();
+        int fine = cellsPerAxis(k - 1), coarse = cellsPerAxis(k);
+        vector<uint64_t> level(static_cast<size_t>(coarse) * coarse, 0);
+        for (int y = 0; y < fine; y++)
+            for (int x = 0; x < fine; x++)
+                level[static_cast<size_t>(y / 2) * coarse + x / 2] += finer[static_cast<size_t>(y) * fine + x];
+        result.push_back(move(level));
+    }
+    return result;
+}
+
+vector<uint64_t> Heatmap::level(int k, int threads) const {
+    if (k >= levels) return {};
+    if (k <= 0) return counters.snapshot(threads);
+    vector<uint64_t> fine = counters.snapshot(threads);
+    int coarse = cellsPerAxis(k);
+    vector<uint64_t> result(static_cast<size_t>(coarse) * coarse, 0);
+    for (int y = 0; y < resolution; y++)
+        for (int x = 0; x < resolution; x++)
+            result[static_cast<size_t>(y >> k) * coarse + (x >> k)] += fine[static_cast<size_t>(y) * resolution + x];
+    return result;
+}
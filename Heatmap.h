@@ -0,0 +1,180 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "FrozenGraph.h"
+#include "Proximity.h"
+using namespace std;
+
+// Counters written by many threads without locks: like LatencyHistogram, every
+// writing thread gets its own shard and updates it with relaxed single-writer
+// stores. Batch updates use one reusable shard per worker instead. snapshot()
+// sums the shards, each thread of the reduction handling a slice of the counters.
+// When a thread exits, its shard (counts included) goes back to a free list and
+// the next new thread writes to it, so short-lived workers do not add shards.
+class ShardedCounters {
+public:
+    explicit ShardedCounters(size_t counterCount);
+    ShardedCounters(const ShardedCounters&) = delete;
+    ShardedCounters& operator=(const ShardedCounters&) = delete;
+
+    size_t size() const { return count; }
+    // Shards allocated so far (thread and batch ones).
+    size_t shardCount() const;
+
+    // Hot path: one increment in the calling thread's shard.
+    void add(size_t index, uint64_t by = 1) { bump(localShard()[index], by); }
+
+    // Shard reserved for batch worker `worker`; a batch must not run concurrently
+    // with another batch using the same worker numbers.
+    atomic<uint64_t>* batchShard(int worker);
+    static void bump(atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+    }
+
+    vector<uint64_t> snapshot(int threads = 1) const;
+    void reset();
+
+private:
+    using Shard = unique_ptr<atomic<uint64_t>[]>;
+
+    // Shared with the threads' exit hooks, which return shards to it as long as
+    // the counters still exist.
+    struct ShardPool {
+        mutex lock;
+        vector<Shard> threadShards; // owned here so counts survive thread exit
+        vector<Shard> workerShards;
+        vector<atomic<uint64_t>*> freeShards; // thread shards of exited threads
+    };
+
+    // Per thread: shard of each instance (by id), returned to the pools at exit.
+    struct ThreadShards {
+        vector<atomic<uint64_t>*> byId;
+        vector<pair<weak_ptr<ShardPool>, atomic<uint64_t>*>> owned;
+        ~ThreadShards();
+    };
+
+    atomic<uint64_t>* localShard() {
+        thread_local ThreadShards local;
+        if (id >= local.byId.size()) local.byId.resize(id + 1, nullptr);
+        atomic<uint64_t>*& s = local.byId[id];
+        if (!s) s = localShardSlow(local);
+        return s;
+    }
+    atomic<uint64_t>* localShardSlow(ThreadShards& local);
+    atomic<uint64_t>* addShard(vector<Shard>& list);
+
+    size_t count;
+    size_t id; // unique per instance, indexes the thread-local shard tables
+    shared_ptr<ShardPool> pool;
+};
+
+// Density raster of vehicle positions over a fixed area.
+//
+// The finest level has `resolution` x `resolution` cells (rounded up to a power of
+// two); level k merges 2^k x 2^k of them, down to a single cell, so map tiles of any
+// zoom level can be served from one set of counters. Positions outside the area
+// are clamped to the border cells; a NaN coordinate counts in the first cell.
+class Heatmap {
+public:
+    Heatmap(double minX, double minY, double maxX, double maxY, int resolution = 1024);
+
+    // Live update from any thread.
+    void record(double x, double y) { counters.add(cellOf(x, y)); }
+    // A whole tick of positions, split over `threads` workers.
+    void recordBatch(const FleetPositions& fleet, int threads = static_cast<int>(thread::hardware_concurrency()));
+
+    int levelCount() const { return levels; }
+    int cellsPerAxis(int level) const { return resolution >> level; }
+    // Row-major counts of a level (0 = finest; empty past the last level).
+    vector<uint64_t> level(int level, int threads = 1) const;
+    // All levels, finest first, from a single snapshot.
+    vector<vector<uint64_t>> pyramid(int threads = 1) const;
+
+    void reset() { counters.reset(); }
+
+private:
+    // Clamped in double before the cast, which is undefined for values out of
+    // int range; NaN fails the comparison and lands in cell 0.
+    int axisCell(double v) const { return static_cast<int>(v >= 0 ? min(v, resolution - 1.0) : 0.0); }
+    size_t cellOf(double x, double y) const {
+        int cx = axisCell((x - minX) * scaleX);
+        int cy = axisCell((y - minY) * scaleY);
+        return static_cast<size_t>(cy) * resolution + cx;
+    }
+
+    double minX, minY, scaleX, scaleY;
+    int resolution;
+    int levels;
+    ShardedCounters counters;
+};
+
+// How often each edge of a FrozenGraph is used by the routes vehicles drive
+// (e.g. the vertex sequences returned by Environment::findOptimalRoute).
+template<typename VertexType>
+class EdgeUsage {
+public:
+    explicit EdgeUsage(const FrozenGraph<VertexType>& g) : graph(g), counters(g.edge_count()) {}
+
+    // Counts every edge along the path; consecutive vertices without an edge are skipped.
+    void recordPath(const vector<VertexType>& path) {
+        for (size_t i = 1; i < path.size(); i++) {
+            int edge = edgeIndex(path[i - 1], path[i]);
+            if (edge >= 0) counters.add(static_cast<size_t>(edge));
+        }
+    }
+
+    // Count per CSR edge slot (see FrozenGraph::getTargets).
+    vector<uint64_t> counts(int threads = 1) const { return counters.snapshot(threads); }
+
+    // The `k` most used edges as (from, to, count), most used first. For an
+    // undirected graph both directions are added up and reported once.
+    vector<tuple<VertexType, VertexType, uint64_t>> top(size_t k, int threads = 1) const {
+        vector<uint64_t> used = counts(threads);
+        auto const& offsets = graph.getOffsets();
+        auto const& targets = graph.getTargets();
+        vector<tuple<VertexType, VertexType, uint64_t>> result;
+        for (int u = 0; u < graph.vertex_count(); u++) {
+            for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                int v = targets[e];
+                uint64_t c = used[e];
+                if (!graph.isDirected()) {
+                    if (v < u) continue;
+                    if (v != u) {
+                        int back = slotOf(v, u);
+                        if (back >= 0) c += used[back];
+                    }
+                }
+                if (c > 0) result.emplace_back(graph.vertex_at(u), graph.vertex_at(v), c);
+            }
+        }
+        size_t keep = min(k, result.size());
+        partial_sort(result.begin(), result.begin() + keep, result.end(),
+            [](auto const& a, auto const& b) { return get<2>(a) > get<2>(b); });
+        result.resize(keep);
+        return result;
+    }
+
+    void reset() { counters.reset(); }
+
+private:
+    int slotOf(int u, int v) const {
+        auto const& offsets = graph.getOffsets();
+        auto const& targets = graph.getTargets();
+        for (int e = offsets[u]; e < offsets[u + 1]; e++)
+            if (targets[e] == v) return e;
+        return -1;
+    }
+    int edgeIndex(const VertexType& from, const VertexType& to) const {
+        int u = graph.index_of(from), v = graph.index_of(to);
+        return u < 0 || v < 0 ? -1 : slotOf(u, v);
+    }
+
+    const FrozenGraph<VertexType>& graph;
+    ShardedCounters counters;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <limits>
+#include <map>
+#include <vector>
+#include "Graph.h"
+using namespace std;
+
+// Path-maximum index over a minimum spanning tree (forest) and MST sensitivity analysis.
+//
+// Built from the result of Graph::mst_kruskal. Binary lifting stores, for each
+// vertex, its 2^k-th ancestor and the heaviest edge on the way there, so the
+// heaviest edge on any tree path is found in O(log n). That answers "does a new
+// road u-v with cost w improve the MST?" without rerunning Kruskal: it does
+// exactly when w is below the path maximum (or u and v are in different trees).
+template<typename VertexType>
+class MSTSensitivity {
+public:
+    static constexpr long long Unbounded = numeric_limits<long long>::max();
+
+    struct EdgeTolerance {
+        VertexType u;
+        VertexType v;
+        int weight;
+        bool inTree;
+        // Tree edge: how much its weight may grow before another edge replaces it.
+        // Non-tree edge: how much its weight must drop before it can enter the tree.
+        // Unbounded for bridges (and self-loops).
+        long long tolerance;
+    };
+
+    // Undirected graphs only; for a directed graph the tree is empty.
+    explicit MSTSensitivity(const Graph<VertexType>& g);
+    MSTSensitivity(const Graph<VertexType>& g, const vector<pair<VertexType, VertexType>>& mstEdges);
+
+    int getTotalWeight() const { return totalWeight; }
+
+    // Heaviest edge weight on the tree path u-v; 0 if u == v, -1 if u and v are
+    // in different trees or unknown.
+    int path_max(VertexType u, VertexType v) const;
+
+    // By how much adding edge (u, v, w) lowers the MST weight (0 = no improvement).
+    // An edge joining two trees of the forest returns Unbounded: it always enters the tree.
+    long long improvement(VertexType u, VertexType v, int w) const;
+    bool improves(VertexType u, VertexType v, int w) const { return improvement(u, v, w) > 0; }
+
+    // Tolerance of every edge of the graph (each undirected edge once).
+    vector<EdgeTolerance> sensitivity() const;
+
+private:
+    void build(const Graph<VertexType>& g, const vector<pair<VertexType, VertexType>>& mstEdges);
+    int index_of(const VertexType& v) const;
+    int lca(int a, int b) const;
+    // Heaviest edge on the path from a up to its ancestor at depth `depthTo`.
+    int climb_max(int a, int depthTo) const;
+
+    struct GraphEdge { int a, b, w; };
+    vector<GraphEdge> edges; // every undirected edge once, a <= b
+    map<VertexType, int> vertexToIndex;
+    vector<VertexType> indexToVertex;
+    vector<int> depth, tree, parentWeight;
+    vector<vector<int>> up, upMax; // up[k][v], upMax[k][v]
+    // Tree edges as (min(u,v), max(u,v)) by index -> weight, for sensitivity().
+    map<pair<int, int>, int> treeEdges;
+    int totalWeight = 0;
+};
+
+#include "MSTSensitivity.inl"
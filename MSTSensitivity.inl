@@ -0,0 +1,192 @@
+#include "MSTSensitivity.h"
+
+template<typename VertexType>
+MSTSensitivity<VertexType>::MSTSensitivity(const Graph<VertexType>& g) {
+    build(g, Graph<VertexType>(g).mst_kruskal(false).first);
+}
+
+template<typename VertexType>
+MSTSensitivity<VertexType>::MSTSensitivity(const Graph<VertexType>& g, const vector<pair<VertexType, VertexType>>& mstEdges) {
+    build(g, mstEdges);
+}
+
+template<typename VertexType>
+void MSTSensitivity<VertexType>::build(const Graph<VertexType>& g, const vector<pair<VertexType, VertexType>>& mstEdges) {
+    auto const& adj = g.getAdjacency();
+    int n = 0;
+    for (auto const& [v, _] : adj) {
+        vertexToIndex[v] = n++;
+        indexToVertex.push_back(v);
+    }
+
+    // Each undirected edge appears in both adjacency lists; keep the a <= b copy
+    // (self-loops appear once).
+    for (auto const& [u, neighbors] : adj) {
+        int a = vertexToIndex[u];
+        for (auto const& [v, w] : neighbors) {
+            int b = vertexToIndex[v];
+            if (a <= b) edges.push_back({ a, b, w });
+        }
+    }
+
+    // mst_kruskal returns endpoints only; with parallel edges it used the lightest.
+    vector<vector<pair<int, int>>> children(n);
+    for (auto const& [a, b] : mstEdges) {
+        int w = numeric_limits<int>::max();
+        for (auto const& [to, weight] : adj.at(a))
+            if (to == b) w = min(w, weight);
+        int u = index_of(a), v = index_of(b);
+        children[u].push_back({ v, w });
+        children[v].push_back({ u, w });
+        treeEdges[{ min(u, v), max(u, v) }] = w;
+        totalWeight += w;
+    }
+
+    int levels = 1;
+    while ((1 << levels) < max(n, 1)) levels++;
+    depth.assign(n, -1);
+    tree.assign(n, -1);
+    parentWeight.assign(n, 0);
+    up.assign(levels, vector<int>(n, 0));
+    upMax.assign(levels, vector<int>(n, 0));
+
+    // Iterative DFS from every unvisited vertex; each tree of the forest gets an id.
+    int treeId = 0;
+    for (int root = 0; root < n; root++) {
+        if (depth[root] >= 0) continue;
+        depth[root] = 0;
+        tree[root] = treeId;
+        up[0][root] = root;
+        vector<int> stack = { root };
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            for (auto const& [v, w] : children[u]) {
+                if (depth[v] >= 0) continue;
+                depth[v] = depth[u] + 1;
+                tree[v] = treeId;
+                up[0][v] = u;
+                upMax[0][v] = w;
+                parentWeight[v] = w;
+                stack.push_back(v);
+            }
+        }
+        treeId++;
+    }
+
+    for (int k = 1; k < levels; k++) {
+        for (int v = 0; v < n; v++) {
+            int mid = up[k - 1][v];
+            up[k][v] = up[k - 1][mid];
+            upMax[k][v] = max(upMax[k - 1][v], upMax[k - 1][mid]);
+        }
+    }
+}
+
+template<typename VertexType>
+int MSTSensitivity<VertexType>::index_of(const VertexType& v) const {
+    auto it = vertexToIndex.find(v);
+    return it == vertexToIndex.end() ? -1 : it->second;
+}
+
+template<typename VertexType>
+int MSTSensitivity<VertexType>::climb_max(int a, int depthTo) const {
+    int best = 0;
+    for (int k = static_cast<int>(up.size()) - 1; k >= 0; k--) {
+        if (depth[a] - (1 << k) >= depthTo) {
+            best = max(best, upMax[k][a]);
+            a = up[k][a];
+        }
+    }
+    return best;
+}
+
+template<typename VertexType>
+int MSTSensitivity<VertexType>::lca(int a, int b) const {
+    if (depth[a] < depth[b]) swap(a, b);
+    for (int k = static_cast<int>(up.size()) - 1; k >= 0; k--)
+        if (depth[a] - (1 << k) >= depth[b]) a = up[k][a];
+    if (a == b) return a;
+    for (int k = static_cast<int>(up.size()) - 1; k >= 0; k--) {
+        if (up[k][a] != up[k][b]) {
+            a = up[k][a];
+            b = up[k][b];
+        }
+    }
+    return up[0][a];
+}
+
+template<typename VertexType>
+int MSTSensitivity<VertexType>::path_max(VertexType u, VertexType v) const {
+    int a = index_of(u), b = index_of(v);
+    if (a < 0 || b < 0 || tree[a] != tree[b]) return -1;
+    int c = lca(a, b);
+    return max(climb_max(a, depth[c]), climb_max(b, depth[c]));
+}
+
+template<typename VertexType>
+long long MSTSensitivity<VertexType>::improvement(VertexType u, VertexType v, int w) const {
+    int a = index_of(u), b = index_of(v);
+    if (a < 0 || b < 0 || a == b) return 0;
+    if (tree[a] != tree[b]) return Unbounded;
+    long long gain = static_cast<long long>(path_max(u, v)) - w;
+    return gain > 0 ? gain : 0;
+}
+
+template<typename VertexType>
+vector<typename MSTSensitivity<VertexType>::EdgeTolerance> MSTSensitivity<VertexType>::sensitivity() const {
+    struct Candidate { int w, a, b; };
+    vector<EdgeTolerance> result;
+    vector<Candidate> nonTree;
+    map<pair<int, int>, bool> treeInstanceSeen; // parallel edges: only one copy is the tree edge
+
+    for (auto const& [a, b, w] : edges) {
+        const VertexType& u = indexToVertex[a];
+        const VertexType& v = indexToVertex[b];
+        if (a == b) {
+            result.push_back({ u, v, w, false, Unbounded });
+            continue;
+        }
+        auto it = treeEdges.find({ a, b });
+        if (it != treeEdges.end() && it->second == w && !treeInstanceSeen[{ a, b }]) {
+            treeInstanceSeen[{ a, b }] = true;
+            continue; // filled in below
+        }
+        result.push_back({ u, v, w, false, static_cast<long long>(w) - path_max(u, v) });
+        nonTree.push_back({ w, a, b });
+    }
+
+    // Tree edge (child c, parent) is replaced by the lightest non-tree edge whose
+    // tree path covers it. Non-tree edges are applied lightest first; a DSU jumps
+    // over tree edges that already have their replacement, so each is set once.
+    int n = static_cast<int>(indexToVertex.size());
+    vector<long long> replacement(n, Unbounded);
+    vector<int> jump(n);
+    for (int v = 0; v < n; v++) jump[v] = v;
+    auto find = [&jump](int v) {
+        while (jump[v] != v) {
+            jump[v] = jump[jump[v]];
+            v = jump[v];
+        }
+        return v;
+    };
+
+    sort(nonTree.begin(), nonTree.end(), [](auto const& x, auto const& y) { return x.w < y.w; });
+    for (auto const& e : nonTree) {
+        int c = lca(e.a, e.b);
+        for (int side : { e.a, e.b }) {
+            for (int v = find(side); depth[v] > depth[c]; v = find(v)) {
+                replacement[v] = e.w;
+                jump[v] = up[0][v];
+            }
+        }
+    }
+
+    for (int v = 0; v < n; v++) {
+        if (depth[v] == 0) continue; // root of its tree, no parent edge
+        int p = up[0][v];
+        long long tol = replacement[v] == Unbounded ? Unbounded : replacement[v] - parentWeight[v];
+        result.push_back({ indexToVertex[p], indexToVertex[v], parentWeight[v], true, tol });
+    }
+    return result;
+}
@@ -0,0 +1,209 @@
+#include "Metrics.h"
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define METRICS_HAVE_SOCKETS 1
+#endif
+using namespace std;
+
+namespace {
+    mutex registryMutex;
+    // Histograms are never destroyed: call sites cache references to them. The
+    // map is never destroyed either, so they stay reachable until exit (leak
+    // checkers stay quiet).
+    map<string, LatencyHistogram*>& registry() {
+        static auto* histograms = new map<string, LatencyHistogram*>;
+        return *histograms;
+    }
+
+    atomic<bool> serverRunning{ false };
+    int serverSocket = -1;
+    thread serverThread;
+
+    // Stops a server still running at exit; destroying a joinable thread
+    // would call terminate(). Declared after the server state, so it runs first.
+    struct ServerShutdown {
+        ~ServerShutdown() { Metrics::stopServer(); }
+    } serverShutdown;
+}
+
+uint64_t HistogramSnapshot::percentile(double q) const {
+    if (count == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count));
+    if (rank >= count) rank = count - 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < static_cast<int>(counts.size()); i++) {
+        seen += counts[i];
+        if (seen > rank) return min(LatencyHistogram::bucketUpperBound(i), max);
+    }
+    return max;
+}
+
+LatencyHistogram::ThreadShards::~ThreadShards() {
+    for (auto const& [histogram, shard] : byId)
+        if (shard) histogram->releaseShard(shard);
+}
+
+LatencyHistogram::Shard* LatencyHistogram::acquireShard() {
+    lock_guard<mutex> lock(shardsMutex);
+    if (!freeShards.empty()) {
+        Shard* shard = freeShards.back();
+        freeShards.pop_back();
+        return shard;
+    }
+    shardList.push_back(make_unique<Shard>());
+    return shardList.back().get();
+}
+
+void LatencyHistogram::releaseShard(Shard* shard) {
+    lock_guard<mutex> lock(shardsMutex);
+    freeShards.push_back(shard);
+}
+
+size_t LatencyHistogram::shardCount() const {
+    lock_guard<mutex> lock(shardsMutex);
+    return shardList.size();
+}
+
+HistogramSnapshot LatencyHistogram::snapshot() const {
+    HistogramSnapshot snap;
+    snap.counts.assign(BucketCount, 0);
+    lock_guard<mutex> lock(shardsMutex);
+    for (auto const& shard : shardList) {
+        for (int i = 0; i < BucketCount; i++) {
+            uint64_t c = shard->counts[i].load(memory_order_relaxed);
+            snap.counts[i] += c;
+            snap.count += c;
+        }
+        snap.sum += shard->sum.load(memory_order_relaxed);
+        snap.max = std::max(snap.max, shard->max.load(memory_order_relaxed));
+    }
+    return snap;
+}
+
+void LatencyHistogram::reset() {
+    lock_guard<mutex> lock(shardsMutex);
+    for (auto& shard : shardList) {
+        for (auto& c : shard->counts) c.store(0, memory_order_relaxed);
+        shard->sum.store(0, memory_order_relaxed);
+        shard->max.store(0, memory_order_relaxed);
+    }
+}
+
+LatencyHistogram& Metrics::histogram(const string& name) {
+    lock_guard<mutex> lock(registryMutex);
+    auto& histograms = registry();
+    auto it = histograms.find(name);
+    if (it != histograms.end()) return *it->second;
+    auto* h = new LatencyHistogram(name, histograms.size());
+    histograms[name] = h;
+    return *h;
+}
+
+string Metrics::prometheusText() {
+    vector<LatencyHistogram*> histograms;
+    {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto const& [_, h] : registry()) histograms.push_back(h);
+    }
+
+    static const double quantiles[] = { 0.5, 0.9, 0.99, 0.999 };
+    ostringstream out;
+    out << "# HELP latency_seconds Latency of routing calls and graph queries.\n";
+    out << "# TYPE latency_seconds summary\n";
+    for (auto* h : histograms) {
+        HistogramSnapshot snap = h->snapshot();
+        string label = "operation=\"" + h->getName() + "\"";
+        for (double q : quantiles)
+            out << "latency_seconds{" << label << ",quantile=\"" << q << "\"} " << snap.percentile(q) / 1e9 << "\n";
+        out << "latency_seconds_sum{" << label << "} " << snap.sum / 1e9 << "\n";
+        out << "latency_seconds_count{" << label << "} " << snap.count << "\n";
+    }
+    return out.str();
+}
+
+bool Metrics::writePrometheusFile(const string& path) {
+    string tmp = path + ".tmp";
+    {
+        ofstream file(tmp);
+        if (!file) return false;
+        file << prometheusText();
+        if (!file) return false;
+    }
+    return rename(tmp.c_str(), path.c_str()) == 0;
+}
+
+bool Metrics::startServer(int port) {
+#ifdef METRICS_HAVE_SOCKETS
+    if (serverRunning) return true;
+    if (serverThread.joinable()) serverThread.join(); // stopped by an accept error
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    int yes = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || listen(fd, 8) < 0) {
+        close(fd);
+        return false;
+    }
+    serverSocket = fd;
+    serverRunning = true;
+    serverThread = thread([fd] {
+        while (serverRunning) {
+            int client = accept(fd, nullptr, nullptr);
+            if (client < 0) {
+                if (errno == EINTR || errno == ECONNABORTED) continue;
+                // Out of descriptors or memory: wait for some to be released instead of spinning.
+                if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    this_thread::sleep_for(chrono::milliseconds(100));
+                    continue;
+                }
+                break; // closed by stopServer(), or a permanent error
+            }
+            char request[1024];
+            (void)!recv(client, request, sizeof(request), 0); // any request gets the metrics page
+            string body = prometheusText();
+            string response = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                + to_string(body.size()) + "\r\n\r\n" + body;
+            (void)!send(client, response.data(), response.size(), 0);
+            close(client);
+        }
+        // After a permanent error nothing listens any more: mark the server as
+        // stopped so that startServer() can open a new socket. Whoever clears
+        // serverRunning first closes the socket.
+        if (serverRunning.exchange(false)) close(fd);
+    });
+    return true;
+#else
+    (void)port;
+    return false;
+#endif
+}
+
+void Metrics::stopServer() {
+#ifdef METRICS_HAVE_SOCKETS
+    if (serverRunning.exchange(false)) {
+        shutdown(serverSocket, SHUT_RDWR); // wakes the blocked accept()
+        close(serverSocket);
+    }
+    // Also joins a server thread that already stopped on an accept error.
+    if (serverThread.joinable()) serverThread.join();
+    serverSocket = -1;
+#endif
+}
+
+void Metrics::resetAll() {
+    lock_guard<mutex> lock(registryMutex);
+    for (auto& [_, h] : registry()) h->reset();
+}
@@ -0,0 +1,164 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Latency histograms for routing calls and graph queries, exposed in the
+// Prometheus text format.
+//
+// Values are nanoseconds in log-linear buckets (32 sub-buckets per power of two,
+// about 3% relative error) covering the full uint64 range. Each thread records into
+// its own shard with relaxed single-writer stores, so recording is a bucket index
+// computation and one increment; shards are merged only when a snapshot is taken.
+// A thread's shard is handed to the next new thread once it exits, so workers
+// started per call do not add shards.
+// Call sites use METRICS_LATENCY, which compiles to nothing unless ENABLE_METRICS is defined.
+
+class HistogramSnapshot {
+public:
+    vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t sum = 0; // ns
+    uint64_t max = 0; // ns
+
+    // Value (ns) at quantile q in [0, 1]; upper bound of the bucket holding it.
+    uint64_t percentile(double q) const;
+};
+
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBuckets = 1 << SubBucketBits;
+    static constexpr int BucketCount = (64 - SubBucketBits + 1) * SubBuckets;
+
+    static int bucketIndex(uint64_t value) {
+        if (value < SubBuckets) return static_cast<int>(value);
+        int msb = 63 - countLeadingZeros(value);
+        int shift = msb - SubBucketBits;
+        return (shift + 1) * SubBuckets + static_cast<int>((value >> shift) & (SubBuckets - 1));
+    }
+    static uint64_t bucketLowerBound(int index) {
+        if (index < SubBuckets) return index;
+        int shift = index / SubBuckets - 1;
+        return static_cast<uint64_t>(SubBuckets + index % SubBuckets) << shift;
+    }
+    static uint64_t bucketUpperBound(int index) {
+        if (index < SubBuckets) return index;
+        int shift = index / SubBuckets - 1;
+        return bucketLowerBound(index) + (uint64_t(1) << shift) - 1;
+    }
+
+    const string& getName() const { return name; }
+
+    void record(uint64_t ns) {
+        Shard& s = localShard();
+        bump(s.counts[bucketIndex(ns)], 1);
+        bump(s.sum, ns);
+        if (ns > s.max.load(memory_order_relaxed)) s.max.store(ns, memory_order_relaxed);
+    }
+
+    HistogramSnapshot snapshot() const;
+    void reset();
+    // Shards allocated so far.
+    size_t shardCount() const;
+
+private:
+    friend class Metrics;
+
+    struct Shard {
+        atomic<uint64_t> counts[BucketCount] = {};
+        atomic<uint64_t> sum{ 0 };
+        atomic<uint64_t> max{ 0 };
+    };
+
+    LatencyHistogram(string histogramName, size_t histogramId) : name(move(histogramName)), id(histogramId) {}
+
+    // Only the owning thread writes a shard, so a plain load + store is enough.
+    static void bump(atomic<uint64_t>& counter, uint64_t by) {
+        counter.store(counter.load(memory_order_relaxed) + by, memory_order_relaxed);
+    }
+
+    static int countLeadingZeros(uint64_t v) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_clzll(v);
+#else
+        int n = 0;
+        for (uint64_t bit = uint64_t(1) << 63; !(v & bit); bit >>= 1) n++;
+        return n;
+#endif
+    }
+
+    // Per thread: shard of each histogram (by id), released at thread exit.
+    // Histograms are never destroyed, so the owners are still there.
+    struct ThreadShards {
+        vector<pair<LatencyHistogram*, Shard*>> byId;
+        ~ThreadShards();
+    };
+
+    Shard& localShard() {
+        thread_local ThreadShards local;
+        if (id >= local.byId.size()) local.byId.resize(id + 1, { nullptr, nullptr });
+        auto& s = local.byId[id];
+        if (!s.second) s = { this, acquireShard() };
+        return *s.second;
+    }
+    Shard* acquireShard();
+    void releaseShard(Shard* shard);
+
+    string name;
+    size_t id;
+    mutable mutex shardsMutex;
+    vector<unique_ptr<Shard>> shardList; // owned here so counts survive thread exit
+    vector<Shard*> freeShards;           // shards of exited threads, counts kept
+};
+
+class Metrics {
+public:
+    // Histogram registered under `name`; created on first use, lives for the whole program.
+    static LatencyHistogram& histogram(const string& name);
+
+    // All histograms in the Prometheus text exposition format (summary with
+    // p50/p90/p99/p999, _sum and _count in seconds).
+    static string prometheusText();
+
+    // Writes prometheusText() to `path` (via a temporary file and rename, so a
+    // scraper never reads a partial file).
+    static bool writePrometheusFile(const string& path);
+
+    // Serves prometheusText() over HTTP on 127.0.0.1:port from a background thread.
+    // Returns false when the socket cannot be opened or sockets are unsupported.
+    static bool startServer(int port);
+    static void stopServer();
+
+    static void resetAll();
+};
+
+class ScopedLatency {
+    LatencyHistogram& histogram;
+    chrono::steady_clock::time_point start;
+public:
+    explicit ScopedLatency(LatencyHistogram& h) : histogram(h), start(chrono::steady_clock::now()) {}
+    ~ScopedLatency() {
+        histogram.record(static_cast<uint64_t>(
+            chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count()));
+    }
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+};
+
+#define METRICS_CONCAT_INNER(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_METRICS
+#define METRICS_LATENCY(name) \
+    static LatencyHistogram& METRICS_CONCAT(metricsHistogram_, __LINE__) = Metrics::histogram(name); \
+    ScopedLatency METRICS_CONCAT(metricsScope_, __LINE__)(METRICS_CONCAT(metricsHistogram_, __LINE__))
+#else
+#define METRICS_LATENCY(name) ((void)0)
+#endif
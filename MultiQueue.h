@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// Relaxed concurrent priority queue (MultiQueue).
+//
+// c * threads ordinary binary heaps, each behind its own spin lock. push() goes to
+// a random heap; try_pop() samples two random heaps and pops from the one whose
+// top is smaller. The popped element is not always the global minimum: with
+// m = c * threads heaps its expected rank is O(m) and the rank stays O(m log m)
+// with high probability (Rihani, Sanders, Dementiev, "MultiQueues", SPAA 2015).
+template<typename Key, typename Value>
+class MultiQueue {
+    struct alignas(64) Heap {
+        atomic<bool> locked{ false };
+        atomic<Key> top{ numeric_limits<Key>::max() }; // readable without the lock
+        priority_queue<pair<Key, Value>, vector<pair<Key, Value>>, greater<pair<Key, Value>>> items;
+
+        bool try_lock() { return !locked.load(memory_order_relaxed) && !locked.exchange(true, memory_order_acquire); }
+        void unlock() { locked.store(false, memory_order_release); }
+        void refresh_top() {
+            top.store(items.empty() ? numeric_limits<Key>::max() : items.top().first, memory_order_relaxed);
+        }
+    };
+
+    vector<Heap> heaps;
+
+    static uint64_t next_random() {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ hash<thread::id>()(this_thread::get_id());
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+    size_t random_heap() { return static_cast<size_t>(next_random() % heaps.size()); }
+
+public:
+    explicit MultiQueue(int threads, int c = 2) : heaps(static_cast<size_t>(max(1, threads) * max(1, c))) {}
+
+    size_t heap_count() const { return heaps.size(); }
+
+    void push(Key key, Value value) {
+        for (;;) {
+            Heap& h = heaps[random_heap()];
+            if (!h.try_lock()) continue;
+            h.items.push({ key, value });
+            if (key < h.top.load(memory_order_relaxed)) h.top.store(key, memory_order_relaxed);
+            h.unlock();
+            return;
+        }
+    }
+
+    // Pops an element close to the minimum. Returns false if the sampled heaps
+    // looked empty a few times in a row (the queue is then empty or nearly so).
+    bool try_pop(Key& key, Value& value) {
+        for (int attempt = 0; attempt < 8 * static_cast<int>(heaps.size()); attempt++) {
+            size_t a = random_heap(), b = random_heap();
+            Key ka = heaps[a].top.load(memory_order_relaxed);
+            Key kb = heaps[b].top.load(memory_order_relaxed);
+            Heap& h = heaps[kb < ka ? b : a];
+            if (min(ka, kb) == numeric_limits<Key>::max()) continue;
+            if (!h.try_lock()) continue;
+            if (h.items.empty()) {
+                h.unlock();
+                continue;
+            }
+            key = h.items.top().first;
+            value = h.items.top().second;
+            h.items.pop();
+            h.refresh_top();
+            h.unlock();
+            return true;
+        }
+        return false;
+    }
+};
@@ -0,0 +1,102 @@
+#include "Numa.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <string>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+using namespace std;
+
+namespace {
+    // Parses a sysfs cpu list such as "0-3,8-11".
+    vector<int> parseCpuList(const string& text) {
+        vector<int> cpus;
+        stringstream ss(text);
+        string part;
+        while (getline(ss, part, ',')) {
+            if (part.empty() || part == "\n") continue;
+            size_t dash = part.find('-');
+            int first = stoi(part.substr(0, dash));
+            int last = dash == string::npos ? first : stoi(part.substr(dash + 1));
+            for (int c = first; c <= last; c++) cpus.push_back(c);
+        }
+        return cpus;
+    }
+}
+
+NumaTopology::NumaTopology() {
+#ifdef __linux__
+    for (int node = 0;; node++) {
+        ifstream in("/sys/devices/system/node/node" + to_string(node) + "/cpulist");
+        if (!in) break;
+        string line;
+        getline(in, line);
+        nodeCpus.push_back(parseCpuList(line));
+    }
+#endif
+    if (nodeCpus.empty()) {
+        int n = max(1, static_cast<int>(thread::hardware_concurrency()));
+        nodeCpus.emplace_back();
+        for (int c = 0; c < n; c++) nodeCpus[0].push_back(c);
+    }
+
+    int maxCpu = 0;
+    for (auto const& cpus : nodeCpus)
+        for (int c : cpus) maxCpu = max(maxCpu, c);
+    cpuNode.assign(maxCpu + 1, 0);
+    for (int node = 0; node < nodeCount(); node++) {
+        for (int c : nodeCpus[node]) cpuNode[c] = node;
+        if (!nodeCpus[node].empty()) nodesWithCpus.push_back(node);
+    }
+    if (nodesWithCpus.empty()) nodesWithCpus.push_back(0);
+}
+
+const NumaTopology& NumaTopology::get() {
+    static const NumaTopology topology;
+    return topology;
+}
+
+int NumaTopology::nodeOfCpu(int cpu) const {
+    if (cpu < 0 || cpu >= static_cast<int>(cpuNode.size())) return 0;
+    return cpuNode[cpu];
+}
+
+int NumaTopology::currentNode() const {
+#ifdef __linux__
+    return nodeOfCpu(sched_getcpu());
+#else
+    return 0;
+#endif
+}
+
+bool NumaTopology::pinCurrentThreadToNode(int node) const {
+#ifdef __linux__
+    if (node < 0 || node >= nodeCount() || nodeCpus[node].empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : nodeCpus[node]) CPU_SET(c, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)node;
+    return false;
+#endif
+}
+
+NumaWorkerPool::NumaWorkerPool(int threadCount) : threads(max(1, threadCount)) {}
+
+void NumaWorkerPool::parallel_for(size_t count, const function<void(size_t, int)>& task) const {
+    atomic<size_t> next{ 0 };
+    vector<thread> workers;
+    for (int w = 0; w < threads; w++) {
+        workers.emplace_back([&, w] {
+            int node = nodeOfWorker(w);
+            NumaTopology::get().pinCurrentThreadToNode(node);
+            for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+                task(i, node);
+        });
+    }
+    for (auto& t : workers) t.join();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <functional>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// NUMA topology and thread placement.
+// Read from /sys/devices/system/node on Linux; everywhere else (or when the
+// information is missing) the machine is treated as a single node.
+class NumaTopology {
+    vector<vector<int>> nodeCpus;
+    vector<int> cpuNode;
+    vector<int> nodesWithCpus;
+public:
+    NumaTopology();
+
+    static const NumaTopology& get();
+
+    int nodeCount() const { return static_cast<int>(nodeCpus.size()); }
+    const vector<int>& cpusOfNode(int node) const { return nodeCpus[node]; }
+    // Nodes that have CPUs (memory-only nodes, e.g. CXL or HBM, have none). Never empty.
+    const vector<int>& computeNodes() const { return nodesWithCpus; }
+    int nodeOfCpu(int cpu) const;
+
+    // Node of the CPU the calling thread is running on (0 if unknown).
+    int currentNode() const;
+
+    // Restricts the calling thread to the CPUs of `node`. Returns false if unsupported.
+    bool pinCurrentThreadToNode(int node) const;
+};
+
+// Worker threads spread round-robin over the NUMA nodes that have CPUs, each
+// pinned to its node.
+// Threads are started per parallel_for call.
+class NumaWorkerPool {
+    int threads;
+public:
+    explicit NumaWorkerPool(int threadCount = static_cast<int>(thread::hardware_concurrency()));
+
+    int threadCount() const { return threads; }
+    static int nodeOfWorker(int worker) {
+        auto const& nodes = NumaTopology::get().computeNodes();
+        return nodes[worker % nodes.size()];
+    }
+
+    // Calls task(index, node) for every index in [0, count); indices are handed
+    // out dynamically, `node` is the node of the worker running the call.
+    void parallel_for(size_t count, const function<void(size_t, int)>& task) const;
+};
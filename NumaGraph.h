@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "FrozenGraph.h"
+#include "Numa.h"
+using namespace std;
+
+enum class NumaPlacement {
+    Replicated,  // one copy of the read-only arrays per node with CPUs, queries use the local one
+    Interleaved  // a single copy whose pages are spread over all nodes by first touch
+};
+
+// FrozenGraph placed for NUMA machines.
+template<typename VertexType>
+class NumaGraph {
+    vector<unique_ptr<FrozenGraph<VertexType>>> replicas;
+    vector<int> slotOfNode; // replica of each node; memory-only nodes share slot 0
+    NumaPlacement placement;
+
+public:
+    NumaGraph(const Graph<VertexType>& g, NumaPlacement mode = NumaPlacement::Replicated,
+        PageBacking pages = PageBacking::Default)
+        : placement(mode) {
+        FrozenGraph<VertexType> master(g, pages);
+        int nodes = NumaTopology::get().nodeCount();
+
+        if (mode == NumaPlacement::Replicated) {
+            // One replica per node with CPUs: no thread runs on a memory-only node, and
+            // its replica could not be first-touched there. Each replica is copied by a
+            // thread pinned to its node, so its pages land there.
+            auto const& computeNodes = NumaTopology::get().computeNodes();
+            slotOfNode.assign(nodes, 0);
+            replicas.resize(computeNodes.size());
+            vector<thread> builders;
+            for (size_t slot = 0; slot < computeNodes.size(); slot++) {
+                int node = computeNodes[slot];
+                if (node < nodes) slotOfNode[node] = static_cast<int>(slot);
+                builders.emplace_back([&, slot, node] {
+                    NumaTopology::get().pinCurrentThreadToNode(node);
+                    replicas[slot] = make_unique<FrozenGraph<VertexType>>(master.clone(
+                        [](auto& dst, auto const& src) { dst.assign(src.begin(), src.end()); }));
+                });
+            }
+            for (auto& t : builders) t.join();
+        }
+        else {
+            replicas.push_back(make_unique<FrozenGraph<VertexType>>(master.clone(
+                [nodes](auto& dst, auto const& src) { interleavedCopy(dst, src, nodes); })));
+        }
+    }
+
+    NumaPlacement getPlacement() const { return placement; }
+    int replicaCount() const { return static_cast<int>(replicas.size()); }
+    // Replica used by threads on `node`.
+    const FrozenGraph<VertexType>& replica(int node) const {
+        bool known = node >= 0 && node < static_cast<int>(slotOfNode.size());
+        return *replicas[known ? slotOfNode[node] : 0];
+    }
+
+    // Replica for the node the calling thread runs on.
+    const FrozenGraph<VertexType>& local() const {
+        return replica(replicas.size() == 1 ? 0 : NumaTopology::get().currentNode());
+    }
+
+    pair<vector<VertexType>, int> shortest_path(VertexType start, VertexType end, bool print) const {
+        return local().shortest_path(start, end, print);
+    }
+
+private:
+    // Parallel first-touch copy: chunk i is written by a thread pinned to node i % nodes.
+    template<typename Array>
+    static void interleavedCopy(Array& dst, const Array& src, int nodes) {
+        dst.resize(src.size()); // leaves pages untouched (PageAllocator)
+        const size_t chunk = 1 << 16; // elements; several pages per chunk
+        size_t chunks = (src.size() + chunk - 1) / chunk;
+        vector<thread> workers;
+        for (int node = 0; node < nodes; node++) {
+            workers.emplace_back([&, node] {
+                NumaTopology::get().pinCurrentThreadToNode(node);
+                for (size_t c = node; c < chunks; c += nodes) {
+                    size_t b = c * chunk, e = min(src.size(), b + chunk);
+                    copy(src.begin() + b, src.begin() + e, dst.begin() + b);
+                }
+            });
+        }
+        for (auto& t : workers) t.join();
+    }
+};
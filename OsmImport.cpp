@@ -0,0 +1,866 @@
+#include "OsmImport.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string_view>
+#include <zlib.h>
+#include "Trace.h"
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+    struct OsmTag {
+        string_view key, value;
+    };
+
+    string_view findTag(const vector<OsmTag>& tags, string_view key) {
+        for (auto const& t : tags)
+            if (t.key == key) return t.value;
+        return {};
+    }
+
+    // Receives the elements of one chunk of the file.
+    class OsmHandler {
+    public:
+        virtual ~OsmHandler() = default;
+        bool wantNodes = false;
+        bool wantWays = false;
+        virtual void node(long long, double, double, const vector<OsmTag>&) {}
+        virtual void way(long long, const vector<long long>&, const vector<OsmTag>&) {}
+    };
+
+    // A file split into chunks that can be parsed independently and in any order.
+    class OsmReader {
+    public:
+        virtual ~OsmReader() = default;
+        virtual size_t chunkCount() const = 0;
+        // False if the chunk is malformed or uses an unsupported feature.
+        virtual bool parseChunk(size_t chunk, OsmHandler& handler) = 0;
+    };
+
+    // ---------------------------------------------------------------- file access
+
+    // Whole file, mapped where mmap is available.
+    class FileView {
+    public:
+        ~FileView() {
+#ifdef __linux__
+            if (mapping) munmap(mapping, length);
+#endif
+        }
+        bool open(const string& path) {
+#ifdef __linux__
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return false;
+            struct stat st;
+            if (fstat(fd, &st) == 0 && st.st_size > 0) {
+                length = static_cast<size_t>(st.st_size);
+                mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) mapping = nullptr;
+                else madvise(mapping, length, MADV_SEQUENTIAL);
+            }
+            ::close(fd);
+            if (mapping) {
+                bytes = static_cast<const char*>(mapping);
+                return true;
+            }
+            if (length > 0) return false;
+#endif
+            ifstream in(path, ios::binary);
+            if (!in) return false;
+            copy.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+            bytes = copy.data();
+            length = copy.size();
+            return true;
+        }
+        const char* data() const { return bytes; }
+        size_t size() const { return length; }
+
+    private:
+        void* mapping = nullptr;
+        const char* bytes = nullptr;
+        size_t length = 0;
+        string copy;
+    };
+
+    // ---------------------------------------------------------------- XML
+
+    bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\n' || c == '\r'; }
+
+    // Decodes the predefined entities and character references of an attribute value.
+    string_view decodeXml(string_view raw, deque<string>& storage) {
+        if (raw.find('&') == string_view::npos) return raw;
+        string& out = storage.emplace_back();
+        for (size_t i = 0; i < raw.size(); i++) {
+            size_t semi = raw[i] == '&' ? raw.find(';', i) : string_view::npos;
+            if (semi == string_view::npos) {
+                out += raw[i];
+                continue;
+            }
+            string_view entity = raw.substr(i + 1, semi - i - 1);
+            if (entity == "amp") out += '&';
+            else if (entity == "lt") out += '<';
+            else if (entity == "gt") out += '>';
+            else if (entity == "quot") out += '"';
+            else if (entity == "apos") out += '\'';
+            else if (!entity.empty() && entity[0] == '#') {
+                bool hex = entity.size() > 1 && (entity[1] == 'x' || entity[1] == 'X');
+                unsigned long code = strtoul(string(entity.substr(hex ? 2 : 1)).c_str(), nullptr, hex ? 16 : 10);
+                // UTF-8 encoding of the code point.
+                if (code < 0x80) out += static_cast<char>(code);
+                else if (code < 0x800) {
+                    out += static_cast<char>(0xC0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else if (code < 0x10000) {
+                    out += static_cast<char>(0xE0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+                else {
+                    out += static_cast<char>(0xF0 | (code >> 18));
+                    out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+                    out += static_cast<char>(0x80 | (code & 0x3F));
+                }
+            }
+            else {
+                out.append(raw.substr(i, semi - i + 1));
+            }
+            i = semi;
+        }
+        return out;
+    }
+
+    // .osm files: the file is cut into ranges that start at a <node>, <way> or
+    // <relation> element; a range owns the elements that start inside it.
+    class XmlReader : public OsmReader {
+    public:
+        bool open(const string& path, int threads) {
+            if (!file.open(path)) return false;
+            text = string_view(file.data(), file.size());
+            size_t ranges = max<size_t>(1, min<size_t>(static_cast<size_t>(max(1, threads)) * 8, text.size() / (1 << 20) + 1));
+            starts.push_back(elementStart(0));
+            for (size_t r = 1; r < ranges; r++)
+                starts.push_back(max(starts.back(), elementStart(text.size() * r / ranges)));
+            starts.push_back(text.size());
+            return text.find("<osm") != string_view::npos;
+        }
+
+        size_t chunkCount() const override { return starts.size() - 1; }
+
+        bool parseChunk(size_t chunk, OsmHandler& handler) override {
+            size_t pos = starts[chunk], end = starts[chunk + 1];
+            vector<OsmTag> tags;
+            vector<long long> refs;
+            deque<string> decoded;
+            while (pos < end) {
+                pos = text.find('<', pos);
+                if (pos >= end) break;
+                string_view name = tagName(pos);
+                if (name == "node" || name == "way") {
+                    bool isNode = name == "node";
+                    bool wanted = isNode ? handler.wantNodes : handler.wantWays;
+                    long long id = 0;
+                    double lat = 0, lon = 0;
+                    bool selfClosing = false;
+                    pos = parseAttributes(pos + 1 + name.size(), selfClosing, [&](string_view key, string_view value) {
+                        if (!wanted) return;
+                        if (key == "id") id = strtoll(value.data(), nullptr, 10);
+                        else if (key == "lat") lat = strtod(value.data(), nullptr);
+                        else if (key == "lon") lon = strtod(value.data(), nullptr);
+                    });
+                    if (pos == string_view::npos) return false;
+                    tags.clear();
+                    refs.clear();
+                    decoded.clear();
+                    if (!selfClosing) {
+                        pos = parseChildren(pos, name, wanted, tags, refs, decoded);
+                        if (pos == string_view::npos) return false;
+                    }
+                    if (!wanted) continue;
+                    if (isNode) handler.node(id, lat, lon, tags);
+                    else handler.way(id, refs, tags);
+                }
+                else if (name == "relation") {
+                    bool selfClosing = false;
+                    pos = parseAttributes(pos + 1 + name.size(), selfClosing, [](string_view, string_view) {});
+                    if (pos == string_view::npos) return false;
+                    if (!selfClosing) {
+                        pos = text.find("</relation>", pos);
+                        if (pos == string_view::npos) return false;
+                    }
+                }
+                else {
+                    pos++;
+                }
+            }
+            return true;
+        }
+
+    private:
+        string_view tagName(size_t lt) const {
+            size_t p = lt + 1;
+            while (p < text.size() && !isSpace(text[p]) && text[p] != '>' && text[p] != '/') p++;
+            return text.substr(lt + 1, p - lt - 1);
+        }
+
+        size_t elementStart(size_t pos) const {
+            while ((pos = text.find('<', pos)) != string_view::npos) {
+                string_view name = tagName(pos);
+                if (name == "node" || name == "way" || name == "relation") return pos;
+                pos++;
+            }
+            return text.size();
+        }
+
+        // Calls fn(name, rawValue) for each attribute of the tag whose name ends at `pos`;
+        // returns the position after the tag, or npos if it is cut off.
+        template<typename Fn>
+        size_t parseAttributes(size_t pos, bool& selfClosing, Fn&& fn) const {
+            for (;;) {
+                while (pos < text.size() && isSpace(text[pos])) pos++;
+                if (pos >= text.size()) return string_view::npos;
+                if (text[pos] == '>') return pos + 1;
+                if (text[pos] == '/') {
+                    selfClosing = true;
+                    return pos + 2 <= text.size() ? pos + 2 : string_view::npos;
+                }
+                size_t eq = text.find('=', pos);
+                if (eq == string_view::npos || eq + 1 >= text.size()) return string_view::npos;
+                size_t nameEnd = eq;
+                while (nameEnd > pos && isSpace(text[nameEnd - 1])) nameEnd--;
+                size_t open = eq + 1;
+                while (open < text.size() && isSpace(text[open])) open++;
+                if (open >= text.size() || (text[open] != '"' && text[open] != '\'')) return string_view::npos;
+                size_t close = text.find(text[open], open + 1);
+                if (close == string_view::npos) return string_view::npos;
+                fn(text.substr(pos, nameEnd - pos), text.substr(open + 1, close - open - 1));
+                pos = close + 1;
+            }
+        }
+
+        // Reads <tag k v/> and <nd ref/> children up to </name>.
+        size_t parseChildren(size_t pos, string_view name, bool wanted, vector<OsmTag>& tags,
+            vector<long long>& refs, deque<string>& decoded) const {
+            for (;;) {
+                pos = text.find('<', pos);
+                if (pos == string_view::npos) return pos;
+                if (text.compare(pos + 1, 1, "/") == 0) {
+                    size_t close = text.find('>', pos);
+                    if (close == string_view::npos) return close;
+                    if (tagName(pos + 1) == name) return close + 1;
+                    pos = close + 1;
+                    continue;
+                }
+                string_view child = tagName(pos);
+                bool selfClosing = false;
+                OsmTag tag;
+                pos = parseAttributes(pos + 1 + child.size(), selfClosing, [&](string_view key, string_view value) {
+                    if (!wanted) return;
+                    if (child == "nd" && key == "ref") refs.push_back(strtoll(value.data(), nullptr, 10));
+                    else if (child == "tag" && key == "k") tag.key = decodeXml(value, decoded);
+                    else if (child == "tag" && key == "v") tag.value = decodeXml(value, decoded);
+                });
+                if (pos == string_view::npos) return pos;
+                if (wanted && child == "tag") tags.push_back(tag);
+            }
+        }
+
+        FileView file;
+        string_view text;
+        vector<size_t> starts;
+    };
+
+    // ---------------------------------------------------------------- PBF
+
+    // Minimal protobuf wire-format reader; `ok` turns false on truncated input.
+    struct ProtoReader {
+        const uint8_t* p;
+        const uint8_t* end;
+        bool ok = true;
+
+        explicit ProtoReader(string_view bytes)
+            : p(reinterpret_cast<const uint8_t*>(bytes.data())), end(p + bytes.size()) {}
+
+        bool atEnd() const { return p >= end || !ok; }
+
+        uint64_t varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (p >= end) break;
+                uint8_t b = *p++;
+                value |= static_cast<uint64_t>(b & 0x7F) << shift;
+                if (!(b & 0x80)) return value;
+            }
+            ok = false;
+            return 0;
+        }
+        int64_t svarint() {
+            uint64_t v = varint();
+            return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+        }
+        string_view bytes() {
+            uint64_t n = varint();
+            if (n > static_cast<uint64_t>(end - p)) {
+                ok = false;
+                return {};
+            }
+            string_view s(reinterpret_cast<const char*>(p), static_cast<size_t>(n));
+            p += n;
+            return s;
+        }
+        // Reads the next field key; false at the end of the message.
+        bool next(uint32_t& field, uint32_t& wire) {
+            if (atEnd()) return false;
+            uint64_t key = varint();
+            field = static_cast<uint32_t>(key >> 3);
+            wire = static_cast<uint32_t>(key & 7);
+            return ok;
+        }
+        void skip(uint32_t wire) {
+            switch (wire) {
+            case 0: varint(); break;
+            case 1: advance(8); break;
+            case 2: bytes(); break;
+            case 5: advance(4); break;
+            default: ok = false;
+            }
+        }
+
+    private:
+        void advance(size_t n) {
+            if (n > static_cast<size_t>(end - p)) ok = false;
+            else p += n;
+        }
+    };
+
+    // Values of a repeated integer field, packed or not: calls fn(value) for each.
+    template<typename Fn>
+    void forPacked(ProtoReader& r, uint32_t wire, bool zigzag, Fn&& fn) {
+        if (wire == 2) {
+            ProtoReader packed(r.bytes());
+            while (!packed.atEnd()) fn(zigzag ? packed.svarint() : static_cast<int64_t>(packed.varint()));
+            if (!packed.ok) r.ok = false;
+        }
+        else if (wire == 0) {
+            fn(zigzag ? r.svarint() : static_cast<int64_t>(r.varint()));
+        }
+        else {
+            r.ok = false;
+        }
+    }
+
+    uint32_t readBigEndian32(const unsigned char* b) {
+        return (uint32_t(b[0]) << 24) | (uint32_t(b[1]) << 16) | (uint32_t(b[2]) << 8) | uint32_t(b[3]);
+    }
+
+    // .osm.pbf files: a sequence of blobs, each an independently compressed
+    // PrimitiveBlock; a chunk is one OSMData blob.
+    class PbfReader : public OsmReader {
+    public:
+        bool open(const string& path) {
+            if (!file.open(path)) return false;
+            size_t pos = 0, size = file.size();
+            const unsigned char* data = reinterpret_cast<const unsigned char*>(file.data());
+            bool sawHeader = false;
+            while (pos < size) {
+                if (size - pos < 4) return false;
+                uint32_t headerSize = readBigEndian32(data + pos);
+                pos += 4;
+                if (headerSize > 64 * 1024 || headerSize > size - pos) return false;
+                ProtoReader header(string_view(file.data() + pos, headerSize));
+                pos += headerSize;
+                string_view type;
+                uint64_t dataSize = 0;
+                uint32_t field, wire;
+                while (header.next(field, wire)) {
+                    if (field == 1 && wire == 2) type = header.bytes();
+                    else if (field == 3 && wire == 0) dataSize = header.varint();
+                    else header.skip(wire);
+                }
+                if (!header.ok || dataSize > size - pos) return false;
+                string_view blob(file.data() + pos, static_cast<size_t>(dataSize));
+                pos += dataSize;
+                if (type == "OSMHeader") {
+                    string block;
+                    if (!decompress(blob, block) || !checkHeader(block)) return false;
+                    sawHeader = true;
+                }
+                else if (type == "OSMData") {
+                    blobs.push_back(blob);
+                }
+            }
+            hasNodes.assign(blobs.size(), 1);
+            return sawHeader;
+        }
+
+        size_t chunkCount() const override { return blobs.size(); }
+
+        bool parseChunk(size_t chunk, OsmHandler& handler) override {
+            thread_local string block;
+            if (!hasNodes[chunk] && !handler.wantWays) return true;
+            if (!decompress(blobs[chunk], block)) return false;
+            return parseBlock(chunk, block, handler);
+        }
+
+    private:
+        static bool decompress(string_view blob, string& out) {
+            ProtoReader r(blob);
+            string_view raw, zlibData;
+            uint64_t rawSize = 0;
+            bool unsupported = false;
+            uint32_t field, wire;
+            while (r.next(field, wire)) {
+                if (field == 1 && wire == 2) raw = r.bytes();
+                else if (field == 2 && wire == 0) rawSize = r.varint();
+                else if (field == 3 && wire == 2) zlibData = r.bytes();
+                else if (field >= 4 && field <= 7) {
+                    unsupported = true; // lzma, bzip2, lz4, zstd
+                    r.skip(wire);
+                }
+                else r.skip(wire);
+            }
+            if (!r.ok) return false;
+            if (raw.data()) {
+                out.assign(raw);
+                return true;
+            }
+            if (!zlibData.data() || unsupported || rawSize > (64u << 20)) return false;
+            out.resize(static_cast<size_t>(rawSize));
+            uLongf length = static_cast<uLongf>(rawSize);
+            int status = uncompress(reinterpret_cast<Bytef*>(out.data()), &length,
+                reinterpret_cast<const Bytef*>(zlibData.data()), static_cast<uLong>(zlibData.size()));
+            return status == Z_OK && length == rawSize;
+        }
+
+        static bool checkHeader(const string& block) {
+            ProtoReader r(block);
+            uint32_t field, wire;
+            while (r.next(field, wire)) {
+                if (field == 4 && wire == 2) {
+                    string_view feature = r.bytes();
+                    if (feature != "OsmSchema-V0.6" && feature != "DenseNodes") return false;
+                }
+                else r.skip(wire);
+            }
+            return r.ok;
+        }
+
+        bool parseBlock(size_t chunk, const string& block, OsmHandler& handler) {
+            ProtoReader r(block);
+            vector<string_view> strings;
+            vector<string_view> groups;
+            int64_t granularity = 100, latOffset = 0, lonOffset = 0;
+            uint32_t field, wire;
+            while (r.next(field, wire)) {
+                if (field == 1 && wire == 2) {
+                    ProtoReader table(r.bytes());
+                    while (table.next(field, wire)) {
+                        if (field == 1 && wire == 2) strings.push_back(table.bytes());
+                        else table.skip(wire);
+                    }
+                    if (!table.ok) return false;
+                }
+                else if (field == 2 && wire == 2) groups.push_back(r.bytes());
+                else if (field == 17 && wire == 0) granularity = static_cast<int64_t>(r.varint());
+                else if (field == 19 && wire == 0) latOffset = static_cast<int64_t>(r.varint());
+                else if (field == 20 && wire == 0) lonOffset = static_cast<int64_t>(r.varint());
+                else r.skip(wire);
+            }
+            if (!r.ok) return false;
+
+            Block context{ strings, granularity, latOffset, lonOffset, handler, {}, {} };
+            bool anyNodes = false;
+            for (string_view group : groups) {
+                ProtoReader g(group);
+                while (g.next(field, wire)) {
+                    bool nodeGroup = (field == 1 || field == 2) && wire == 2;
+                    anyNodes |= nodeGroup;
+                    if (nodeGroup && handler.wantNodes) {
+                        if (!(field == 1 ? context.node(g.bytes()) : context.denseNodes(g.bytes()))) return false;
+                    }
+                    else if (field == 3 && wire == 2 && handler.wantWays) {
+                        if (!context.way(g.bytes())) return false;
+                    }
+                    else g.skip(wire);
+                }
+                if (!g.ok) return false;
+            }
+            // Each chunk is parsed by one worker, so this flag has a single writer.
+            hasNodes[chunk] = anyNodes;
+            return true;
+        }
+
+        struct Block {
+            const vector<string_view>& strings;
+            int64_t granularity, latOffset, lonOffset;
+            OsmHandler& handler;
+            vector<OsmTag> tags;
+            vector<long long> refs;
+
+            double lat(int64_t v) const { return 1e-9 * static_cast<double>(latOffset + granularity * v); }
+            double lon(int64_t v) const { return 1e-9 * static_cast<double>(lonOffset + granularity * v); }
+            bool tag(int64_t key, int64_t value) {
+                if (key < 0 || value < 0 || static_cast<size_t>(max(key, value)) >= strings.size()) return false;
+                tags.push_back({ strings[static_cast<size_t>(key)], strings[static_cast<size_t>(value)] });
+                return true;
+            }
+
+            bool node(string_view bytes) {
+                ProtoReader r(bytes);
+                int64_t id = 0, la = 0, lo = 0;
+                vector<int64_t> keys, values;
+                uint32_t field, wire;
+                while (r.next(field, wire)) {
+                    if (field == 1 && wire == 0) id = r.svarint();
+                    else if (field == 2) forPacked(r, wire, false, [&](int64_t v) { keys.push_back(v); });
+                    else if (field == 3) forPacked(r, wire, false, [&](int64_t v) { values.push_back(v); });
+                    else if (field == 8 && wire == 0) la = r.svarint();
+                    else if (field == 9 && wire == 0) lo = r.svarint();
+                    else r.skip(wire);
+                }
+                if (!r.ok || keys.size() != values.size()) return false;
+                tags.clear();
+                for (size_t i = 0; i < keys.size(); i++)
+                    if (!tag(keys[i], values[i])) return false;
+                handler.node(id, lat(la), lon(lo), tags);
+                return true;
+            }
+
+            bool denseNodes(string_view bytes) {
+                ProtoReader r(bytes);
+                string_view ids, lats, lons, keysVals;
+                uint32_t field, wire;
+                while (r.next(field, wire)) {
+                    if (wire == 2 && field == 1) ids = r.bytes();
+                    else if (wire == 2 && field == 8) lats = r.bytes();
+                    else if (wire == 2 && field == 9) lons = r.bytes();
+                    else if (wire == 2 && field == 10) keysVals = r.bytes();
+                    else r.skip(wire);
+                }
+                if (!r.ok) return false;
+                ProtoReader id(ids), la(lats), lo(lons), kv(keysVals);
+                int64_t idValue = 0, laValue = 0, loValue = 0;
+                while (!id.atEnd()) {
+                    idValue += id.svarint();
+                    laValue += la.svarint();
+                    loValue += lo.svarint();
+                    tags.clear();
+                    // keys_vals: key, value, key, value, ..., 0 per node (absent if no node has tags).
+                    while (!kv.atEnd()) {
+                        int64_t key = static_cast<int64_t>(kv.varint());
+                        if (key == 0) break;
+                        if (!tag(key, static_cast<int64_t>(kv.varint()))) return false;
+                    }
+                    if (!id.ok || !la.ok || !lo.ok || !kv.ok) return false;
+                    handler.node(idValue, lat(laValue), lon(loValue), tags);
+                }
+                return id.ok;
+            }
+
+            bool way(string_view bytes) {
+                ProtoReader r(bytes);
+                int64_t id = 0;
+                vector<int64_t> keys, values;
+                refs.clear();
+                int64_t ref = 0;
+                uint32_t field, wire;
+                while (r.next(field, wire)) {
+                    if (field == 1 && wire == 0) id = static_cast<int64_t>(r.varint());
+                    else if (field == 2) forPacked(r, wire, false, [&](int64_t v) { keys.push_back(v); });
+                    else if (field == 3) forPacked(r, wire, false, [&](int64_t v) { values.push_back(v); });
+                    else if (field == 8) forPacked(r, wire, true, [&](int64_t delta) { refs.push_back(ref += delta); });
+                    else r.skip(wire);
+                }
+                if (!r.ok || keys.size() != values.size()) return false;
+                tags.clear();
+                for (size_t i = 0; i < keys.size(); i++)
+                    if (!tag(keys[i], values[i])) return false;
+                handler.way(id, refs, tags);
+                return true;
+            }
+        };
+
+        FileView file;
+        vector<string_view> blobs;
+        vector<char> hasNodes; // from the first pass; node-free blobs are skipped by node-only passes
+    };
+
+    // ---------------------------------------------------------------- import
+
+    // Runs handlers[c] over chunk c for every chunk, on `threads` workers.
+    template<typename Handler>
+    bool runPass(OsmReader& reader, int threads, vector<Handler>& handlers) {
+        atomic<size_t> next(0);
+        atomic<bool> ok(true);
+        auto worker = [&]() {
+            for (size_t c; ok && (c = next++) < handlers.size();)
+                if (!reader.parseChunk(c, handlers[c])) ok = false;
+        };
+        vector<thread> workers;
+        for (int t = 1; t < min<int>(threads, static_cast<int>(handlers.size())); t++) workers.emplace_back(worker);
+        worker();
+        for (auto& w : workers) w.join();
+        return ok;
+    }
+
+    constexpr signed char Skip = 2;
+
+    // Travel direction of a way: 0 both, 1 forward, -1 backward, or Skip if it is
+    // not part of the selected network.
+    signed char wayDirection(const vector<OsmTag>& tags, const OsmImportOptions& options) {
+        static const string_view Roads[] = { "motorway", "motorway_link", "trunk", "trunk_link", "primary",
+            "primary_link", "secondary", "secondary_link", "tertiary", "tertiary_link", "unclassified",
+            "residential", "living_street", "service", "road" };
+        static const string_view Rails[] = { "rail", "light_rail", "subway", "tram", "narrow_gauge", "monorail" };
+
+        string_view highway = findTag(tags, "highway");
+        if (options.roads && find(begin(Roads), end(Roads), highway) != end(Roads)) {
+            if (!options.respectOneway) return 0;
+            string_view oneway = findTag(tags, "oneway");
+            if (oneway == "yes" || oneway == "1" || oneway == "true") return 1;
+            if (oneway == "-1" || oneway == "reverse") return -1;
+            if (oneway == "no") return 0;
+            bool implied = highway == "motorway" || findTag(tags, "junction") == "roundabout";
+            return implied ? 1 : 0;
+        }
+        if (options.rail && find(begin(Rails), end(Rails), findTag(tags, "railway")) != end(Rails)) return 0;
+        if (options.ferries && findTag(tags, "route") == "ferry") return 0;
+        return Skip;
+    }
+
+    struct WayCollector : OsmHandler {
+        const OsmImportOptions* options = nullptr;
+        vector<long long> refs;   // node ids of all collected ways, back to back
+        vector<size_t> starts;    // first ref of each way
+        vector<signed char> directions;
+
+        void way(long long, const vector<long long>& wayRefs, const vector<OsmTag>& tags) override {
+            if (wayRefs.size() < 2) return;
+            signed char direction = wayDirection(tags, *options);
+            if (direction == Skip) return;
+            starts.push_back(refs.size());
+            refs.insert(refs.end(), wayRefs.begin(), wayRefs.end());
+            directions.push_back(direction);
+        }
+    };
+
+    struct NodeCollector : OsmHandler {
+        const vector<long long>* ids = nullptr;  // needed node ids, sorted
+        vector<double>* lat = nullptr;
+        vector<double>* lon = nullptr;
+        vector<char>* found = nullptr;
+        vector<pair<size_t, string>> names;
+        size_t cursor = 0;
+        long long last = 0;
+
+        // Nodes are usually sorted by id, so the search gallops forward from the
+        // previous match instead of starting over.
+        size_t locate(long long id) {
+            const vector<long long>& v = *ids;
+            if (id < last) cursor = 0;
+            last = id;
+            size_t step = 1, hi = cursor;
+            while (hi < v.size() && v[hi] < id) {
+                cursor = hi;
+                hi += step;
+                step *= 2;
+            }
+            cursor = lower_bound(v.begin() + cursor, v.begin() + min(hi, v.size()), id) - v.begin();
+            return cursor < v.size() && v[cursor] == id ? cursor : SIZE_MAX;
+        }
+
+        void node(long long id, double la, double lo, const vector<OsmTag>& tags) override {
+            size_t index = locate(id);
+            if (index == SIZE_MAX) return;
+            // A node is stored once, so each slot has a single writer.
+            (*lat)[index] = la;
+            (*lon)[index] = lo;
+            (*found)[index] = 1;
+            string_view name = findTag(tags, "name");
+            if (!name.empty()) names.emplace_back(index, string(name));
+        }
+    };
+
+    template<typename Fn>
+    void parallelRanges(size_t count, int threads, Fn&& fn) {
+        threads = max(1, min(threads, static_cast<int>(count / 65536) + 1));
+        vector<thread> workers;
+        for (int t = 1; t < threads; t++) workers.emplace_back([&, t]() { fn(count * t / threads, count * (t + 1) / threads); });
+        fn(0, count / threads);
+        for (auto& w : workers) w.join();
+    }
+
+    double haversineMeters(double lat1, double lon1, double lat2, double lon2) {
+        constexpr double EarthRadius = 6371008.8;
+        constexpr double Radians = 3.14159265358979323846 / 180;
+        double dLat = (lat2 - lat1) * Radians, dLon = (lon2 - lon1) * Radians;
+        double a = sin(dLat / 2) * sin(dLat / 2) + cos(lat1 * Radians) * cos(lat2 * Radians) * sin(dLon / 2) * sin(dLon / 2);
+        return 2 * EarthRadius * asin(min(1.0, sqrt(a)));
+    }
+
+    unique_ptr<OsmReader> openReader(const string& path, int threads) {
+        ifstream probe(path, ios::binary);
+        char head[64] = {};
+        if (!probe.read(head, sizeof(head)) && probe.gcount() == 0) return nullptr;
+        size_t n = static_cast<size_t>(probe.gcount()), i = 0;
+        if (n >= 3 && memcmp(head, "\xEF\xBB\xBF", 3) == 0) i = 3;
+        while (i < n && isSpace(head[i])) i++;
+        if (i < n && head[i] == '<') {
+            auto xml = make_unique<XmlReader>();
+            if (!xml->open(path, threads)) return nullptr;
+            return xml;
+        }
+        auto pbf = make_unique<PbfReader>();
+        if (!pbf->open(path)) return nullptr;
+        return pbf;
+    }
+}
+
+bool importOsm(const string& path, OsmNetwork& network, const OsmImportOptions& options, Environment* environment) {
+    TRACE_SCOPE("import", "importOsm");
+    int threads = max(1, options.threads);
+    unique_ptr<OsmReader> reader = openReader(path, threads);
+    if (!reader) return false;
+    size_t chunks = reader->chunkCount();
+
+    // Pass 1: selected ways, merged in file order.
+    vector<WayCollector> wayChunks(chunks);
+    for (auto& h : wayChunks) {
+        h.wantWays = true;
+        h.options = &options;
+    }
+    {
+        TRACE_SCOPE("import", "ways");
+        if (!runPass(*reader, threads, wayChunks)) return false;
+    }
+    vector<long long> refs;
+    vector<size_t> starts;
+    vector<signed char> directions;
+    for (auto& h : wayChunks) {
+        for (size_t s : h.starts) starts.push_back(s + refs.size());
+        refs.insert(refs.end(), h.refs.begin(), h.refs.end());
+        directions.insert(directions.end(), h.directions.begin(), h.directions.end());
+        h = WayCollector();
+    }
+    starts.push_back(refs.size());
+    size_t wayCount = directions.size();
+
+    // Needed nodes; refs are replaced by indices into the sorted id list.
+    vector<long long> ids(refs);
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    vector<int> refIndex(refs.size());
+    parallelRanges(refs.size(), threads, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; i++)
+            refIndex[i] = static_cast<int>(lower_bound(ids.begin(), ids.end(), refs[i]) - ids.begin());
+    });
+    vector<long long>().swap(refs);
+
+    // Junctions: way endpoints and nodes used more than once.
+    vector<unsigned char> uses(ids.size(), 0);
+    vector<char> junction(ids.size(), 0);
+    for (size_t w = 0; w < wayCount; w++) {
+        junction[refIndex[starts[w]]] = 1;
+        junction[refIndex[starts[w + 1] - 1]] = 1;
+        for (size_t i = starts[w]; i < starts[w + 1]; i++)
+            if (++uses[refIndex[i]] > 1) {
+                junction[refIndex[i]] = 1;
+                uses[refIndex[i]] = 2;
+            }
+    }
+    vector<unsigned char>().swap(uses);
+
+    // Pass 2: coordinates and names of the needed nodes.
+    vector<double> lat(ids.size(), 0), lon(ids.size(), 0);
+    vector<char> found(ids.size(), 0);
+    vector<NodeCollector> nodeChunks(chunks);
+    for (auto& h : nodeChunks) {
+        h.wantNodes = true;
+        h.ids = &ids;
+        h.lat = &lat;
+        h.lon = &lon;
+        h.found = &found;
+    }
+    {
+        TRACE_SCOPE("import", "nodes");
+        if (!runPass(*reader, threads, nodeChunks)) return false;
+    }
+    vector<string> names(ids.size());
+    for (auto& h : nodeChunks)
+        for (auto& [index, name] : h.names) names[index] = move(name);
+    nodeChunks.clear();
+    reader.reset();
+
+    // Nodes missing from the extract (clipped ways) split their way; the nodes
+    // next to them become junctions so the remaining pieces are kept.
+    for (size_t w = 0; w < wayCount; w++)
+        for (size_t i = starts[w]; i < starts[w + 1]; i++)
+            if (!found[refIndex[i]]) {
+                if (i > starts[w]) junction[refIndex[i - 1]] = 1;
+                if (i + 1 < starts[w + 1]) junction[refIndex[i + 1]] = 1;
+            }
+
+    TRACE_SCOPE("import", "build");
+    network = OsmNetwork();
+    network.graph = Graph<int>(options.respectOneway);
+    vector<int> vertexOf(ids.size(), -1);
+    for (size_t i = 0; i < ids.size(); i++) {
+        if (!junction[i] || !found[i]) continue;
+        vertexOf[i] = static_cast<int>(network.points.size());
+        string id = "node/" + to_string(ids[i]);
+        network.points.emplace_back(names[i].empty() ? id : names[i] + " (" + id + ")", lon[i], lat[i]);
+        network.nodeIds.push_back(ids[i]);
+        network.graph.add_vertex(vertexOf[i]);
+    }
+    network.wayCount = wayCount;
+
+    // Environment routes are directed, so two-way segments are added both ways.
+    auto addRoute = [&](int a, int b, double km) {
+        const Point& start = network.points[a];
+        const Point& end = network.points[b];
+        const Route* existing = environment->findRoute(start.getName(), end.getName());
+        if (!existing || existing->getDistance() > km) environment->addRoute(Route(start, end, km));
+    };
+    for (size_t w = 0; w < wayCount; w++) {
+        int from = -1;
+        double length = 0;
+        for (size_t i = starts[w]; i < starts[w + 1]; i++) {
+            int node = refIndex[i];
+            if (!found[node]) {
+                from = -1;
+                continue;
+            }
+            if (i > starts[w] && found[refIndex[i - 1]])
+                length += haversineMeters(lat[refIndex[i - 1]], lon[refIndex[i - 1]], lat[node], lon[node]);
+            int v = vertexOf[node];
+            if (v < 0) continue;
+            if (from >= 0 && from != v) {
+                int meters = max(1, static_cast<int>(lround(length)));
+                int a = directions[w] < 0 ? v : from, b = directions[w] < 0 ? from : v;
+                network.graph.add_edge(a, b, meters);
+                if (options.respectOneway && directions[w] == 0) network.graph.add_edge(b, a, meters);
+                network.segmentCount++;
+                if (environment) {
+                    addRoute(a, b, length / 1000);
+                    if (directions[w] == 0) addRoute(b, a, length / 1000);
+                }
+            }
+            from = v;
+            length = 0;
+        }
+    }
+    return true;
+}
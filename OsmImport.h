@@ -0,0 +1,46 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <vector>
+#include "Environment.h"
+#include "Graph.h"
+using namespace std;
+
+struct OsmImportOptions {
+    bool roads = true;          // highway=* ways open to motor vehicles
+    bool rail = false;          // railway=rail, light_rail, subway, tram, narrow_gauge, monorail
+    bool ferries = false;       // route=ferry
+    bool respectOneway = true;  // directed graph following oneway=* (implied on motorways and roundabouts)
+    int threads = static_cast<int>(thread::hardware_concurrency());
+};
+
+// Routable network read from an OpenStreetMap extract.
+//
+// Only way endpoints and nodes shared by several selected ways (junctions) become
+// vertices; the nodes in between are folded into the edge lengths, so the graph
+// is a small fraction of the extract. Vertex i is points[i], located at x =
+// longitude, y = latitude, and named "node/<id>" or "<name> (node/<id>)" when
+// the node has a name tag. Edge weights are lengths in meters (at least 1).
+struct OsmNetwork {
+    Graph<int> graph;
+    vector<Point> points;
+    vector<long long> nodeIds;  // OSM id per vertex
+    size_t wayCount = 0;        // ways that passed the filter
+    size_t segmentCount = 0;    // junction-to-junction pieces of those ways
+};
+
+// Imports an .osm (XML) or .osm.pbf file; the format is detected from the content.
+//
+// The file is read twice so that memory stays proportional to the selected
+// network rather than the extract: the first pass collects the selected ways,
+// the second only the coordinates and names of the nodes they use. Both passes
+// parse PBF blocks (or ranges of XML elements) on `threads` workers, merging the
+// results in file order. When `environment` is given, every segment is also
+// added to it as a Route between the two junction Points, in both directions
+// unless the way is one-way (distance in km; the shortest one is kept where
+// several ways join the same pair of junctions).
+//
+// Returns false if the file cannot be read or is malformed, or if it uses a PBF
+// feature that is not supported (only zlib-compressed or raw blobs are).
+bool importOsm(const string& path, OsmNetwork& network, const OsmImportOptions& options = {},
+    Environment* environment = nullptr);
@@ -0,0 +1,90 @@
+#include "PageAllocator.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+using namespace std;
+
+namespace {
+    size_t roundUp(size_t bytes, size_t to) { return (bytes + to - 1) / to * to; }
+
+    bool useHeap(size_t bytes, PageBacking backing) {
+#ifdef __linux__
+        return backing == PageBacking::Default || bytes < HugePageThreshold;
+#else
+        (void)bytes;
+        (void)backing;
+        return true;
+#endif
+    }
+
+#ifdef __linux__
+#ifdef MAP_HUGE_SHIFT
+    constexpr int HugeTlb2MB = 21 << MAP_HUGE_SHIFT; // MAP_HUGE_2MB
+#else
+    constexpr int HugeTlb2MB = 21 << 26;
+#endif
+
+    // mmap does not align to 2 MB, so map one extra huge page and trim both ends.
+    void* mapAligned(size_t length) {
+        size_t padded = length + HugePageSize;
+        void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) return nullptr;
+        uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+        uintptr_t aligned = roundUp(start, HugePageSize);
+        if (aligned > start) munmap(raw, aligned - start);
+        size_t tail = (start + padded) - (aligned + length);
+        if (tail > 0) munmap(reinterpret_cast<void*>(aligned + length), tail);
+        return reinterpret_cast<void*>(aligned);
+    }
+#endif
+}
+
+void* allocate_pages(size_t bytes, PageBacking backing) {
+    if (useHeap(bytes, backing))
+        return ::operator new(bytes);
+
+#ifdef __linux__
+    size_t length = roundUp(bytes, HugePageSize);
+    if (backing == PageBacking::HugeTLB) {
+        // Ask for 2 MB pages explicitly: with the default pool size (1 GB on some
+        // systems) the mapping would not match the length free_pages unmaps.
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | HugeTlb2MB, -1, 0);
+        if (p != MAP_FAILED) return p;
+    }
+    void* p = mapAligned(length);
+    if (!p) throw bad_alloc();
+#ifdef MADV_HUGEPAGE
+    madvise(p, length, MADV_HUGEPAGE); // only a hint, ignored when THP is disabled
+#endif
+    return p;
+#else
+    return ::operator new(bytes);
+#endif
+}
+
+void free_pages(void* p, size_t bytes, PageBacking backing) {
+    if (!p) return;
+    if (useHeap(bytes, backing)) {
+        ::operator delete(p);
+        return;
+    }
+#ifdef __linux__
+    munmap(p, roundUp(bytes, HugePageSize));
+#endif
+}
+
+bool transparent_huge_pages_available() {
+#ifdef __linux__
+    ifstream in("/sys/kernel/mm/transparent_hugepage/enabled");
+    string mode;
+    getline(in, mode);
+    // The active mode is shown in brackets, e.g. "always [madvise] never".
+    return mode.find("[always]") != string::npos || mode.find("[madvise]") != string::npos;
+#else
+    return false;
+#endif
+}
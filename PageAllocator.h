@@ -0,0 +1,50 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+using namespace std;
+
+// Page backing for large arrays (FrozenGraph arrays, distance arrays, index tables).
+enum class PageBacking {
+    Default,          // regular heap allocation
+    TransparentHuge,  // 2 MB aligned mmap + madvise(MADV_HUGEPAGE)
+    HugeTLB           // MAP_HUGETLB from the 2 MB hugetlbfs pool, TransparentHuge if it is empty
+};
+
+// Raw page allocation. Requests below HugePageThreshold bytes, and every request
+// on platforms without mmap, fall back to the regular heap. free_pages must get
+// the same size and backing that were passed to allocate_pages.
+constexpr size_t HugePageSize = size_t(2) << 20;
+constexpr size_t HugePageThreshold = HugePageSize / 2;
+
+void* allocate_pages(size_t bytes, PageBacking backing);
+void free_pages(void* p, size_t bytes, PageBacking backing);
+
+// True if the kernel allows madvise-driven transparent huge pages.
+bool transparent_huge_pages_available();
+
+// Stateful allocator that places blocks according to its PageBacking.
+// Trivially constructible elements are left uninitialized on resize, so pages are
+// only touched by the code that fills them (this also keeps NUMA first touch working).
+template<typename T>
+class PageAllocator {
+public:
+    using value_type = T;
+    template<typename U> struct rebind { using other = PageAllocator<U>; };
+
+    PageBacking backing;
+
+    PageAllocator(PageBacking b = PageBacking::Default) : backing(b) {}
+    template<typename U> PageAllocator(const PageAllocator<U>& other) : backing(other.backing) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(allocate_pages(n * sizeof(T), backing)); }
+    void deallocate(T* p, size_t n) { free_pages(p, n * sizeof(T), backing); }
+
+    template<typename U>
+    void construct(U* p) { ::new (static_cast<void*>(p)) U; }
+    template<typename U, typename... Args>
+    void construct(U* p, Args&&... args) { ::new (static_cast<void*>(p)) U(std::forward<Args>(args)...); }
+
+    template<typename U> bool operator==(const PageAllocator<U>& other) const { return backing == other.backing; }
+    template<typename U> bool operator!=(const PageAllocator<U>& other) const { return backing != other.backing; }
+};
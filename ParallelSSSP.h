@@ -0,0 +1,106 @@
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "FrozenGraph.h"
+#include "MultiQueue.h"
+using namespace std;
+
+// Parallel single-source shortest paths over a FrozenGraph using a MultiQueue.
+//
+// Workers pop a (distance, vertex) pair, skip it if the vertex has been improved
+// since, and relax its edges with a compare-and-swap minimum on the shared
+// distance array, pushing every improved vertex. Because the queue is relaxed a
+// vertex can be processed before its final distance is known; it is then simply
+// processed again later. The counters report this extra work.
+struct ParallelSsspResult {
+    vector<long long> dist;     // by vertex index, -1 if unreachable
+    size_t processed = 0;       // pops that relaxed edges (n - unreachable for exact Dijkstra)
+    size_t stale = 0;           // pops skipped because the vertex had improved since
+    size_t relaxations = 0;     // successful distance decreases
+};
+
+// Priority of a vertex is dist / delta. delta = 1 gives Dijkstra order (parallel
+// Dijkstra); larger values give a label-correcting search with coarse buckets,
+// which trades more reprocessing for less queue ordering work.
+template<typename VertexType>
+ParallelSsspResult label_correcting_sssp(const FrozenGraph<VertexType>& g, VertexType source, int threads,
+    long long delta = 1) {
+    TRACE_SCOPE("graph", "label_correcting_sssp");
+
+    const long long INF = numeric_limits<long long>::max();
+    size_t n = g.vertex_count();
+    int s = g.index_of(source);
+
+    ParallelSsspResult result;
+    result.dist.assign(n, -1);
+    if (s < 0) return result;
+
+    threads = max(1, threads);
+    delta = max(1LL, delta);
+    vector<atomic<long long>> dist(n);
+    for (auto& d : dist) d.store(INF, memory_order_relaxed);
+    dist[s].store(0, memory_order_relaxed);
+
+    MultiQueue<long long, int> queue(threads);
+    atomic<long long> pending{ 1 }; // pushed but not yet fully processed
+    atomic<size_t> processed{ 0 }, stale{ 0 }, relaxations{ 0 };
+    queue.push(0, s);
+
+    auto const& offsets = g.getOffsets();
+    auto const& targets = g.getTargets();
+    auto const& weights = g.getWeights();
+
+    auto worker = [&] {
+        size_t localProcessed = 0, localStale = 0, localRelaxations = 0;
+        long long priority;
+        int u;
+        while (pending.load(memory_order_acquire) > 0) {
+            if (!queue.try_pop(priority, u)) {
+                this_thread::yield();
+                continue;
+            }
+            long long du = dist[u].load(memory_order_relaxed);
+            if (du / delta < priority) {
+                localStale++;
+            }
+            else {
+                localProcessed++;
+                for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                    int v = targets[e];
+                    long long nd = du + weights[e];
+                    long long old = dist[v].load(memory_order_relaxed);
+                    while (nd < old && !dist[v].compare_exchange_weak(old, nd, memory_order_relaxed)) {}
+                    if (nd < old) {
+                        localRelaxations++;
+                        pending.fetch_add(1, memory_order_relaxed);
+                        queue.push(nd / delta, v);
+                    }
+                }
+            }
+            pending.fetch_sub(1, memory_order_release);
+        }
+        processed += localProcessed;
+        stale += localStale;
+        relaxations += localRelaxations;
+    };
+
+    vector<thread> workers;
+    for (int t = 1; t < threads; t++) workers.emplace_back(worker);
+    worker();
+    for (auto& t : workers) t.join();
+
+    for (size_t v = 0; v < n; v++) {
+        long long d = dist[v].load(memory_order_relaxed);
+        result.dist[v] = d == INF ? -1 : d;
+    }
+    result.processed = processed;
+    result.stale = stale;
+    result.relaxations = relaxations;
+    return result;
+}
+
+template<typename VertexType>
+ParallelSsspResult parallel_dijkstra(const FrozenGraph<VertexType>& g, VertexType source, int threads) {
+    return label_correcting_sssp(g, source, threads, 1);
+}
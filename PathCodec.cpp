@@ -0,0 +1,117 @@
+#include "PathCodec.h"
+#include <cstring>
+#include <fstream>
+#include "Trace.h"
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+namespace {
+    const char Magic[4] = { 'P', 'A', 'R', 'C' };
+    constexpr uint32_t Version = 1;
+    constexpr size_t HeaderSize = 4 + sizeof(uint32_t) + 3 * sizeof(uint64_t);
+
+    template<typename T>
+    T load(const char* p) {
+        T value;
+        memcpy(&value, p, sizeof(T));
+        return value;
+    }
+
+    template<typename T>
+    void put(ofstream& out, T value) { out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+}
+
+bool PathArchiveFile::write(const string& path, uint64_t fingerprint, const vector<int32_t>& starts,
+    const vector<uint32_t>& hops, const vector<uint64_t>& offsets, const string& payload) {
+    TRACE_SCOPE("paths", "write_archive");
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write(Magic, sizeof(Magic));
+    put(out, Version);
+    put(out, fingerprint);
+    put<uint64_t>(out, starts.size());
+    put<uint64_t>(out, payload.size());
+    out.write(reinterpret_cast<const char*>(starts.data()), static_cast<streamsize>(starts.size() * sizeof(int32_t)));
+    out.write(reinterpret_cast<const char*>(hops.data()), static_cast<streamsize>(hops.size() * sizeof(uint32_t)));
+    out.write(reinterpret_cast<const char*>(offsets.data()), static_cast<streamsize>(offsets.size() * sizeof(uint64_t)));
+    out.write(payload.data(), static_cast<streamsize>(payload.size()));
+    return static_cast<bool>(out.flush());
+}
+
+PathArchiveFile::~PathArchiveFile() { close(); }
+
+void PathArchiveFile::close() {
+#ifdef __linux__
+    if (mapping) munmap(mapping, length);
+#endif
+    mapping = nullptr;
+    copy.clear();
+    data = nullptr;
+    length = 0;
+    count = 0;
+}
+
+bool PathArchiveFile::open(const string& path, uint64_t fingerprint) {
+    close();
+#ifdef __linux__
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+        length = static_cast<size_t>(st.st_size);
+        mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) mapping = nullptr;
+    }
+    ::close(fd);
+    if (!mapping) {
+        length = 0;
+        return false;
+    }
+    data = static_cast<const char*>(mapping);
+#else
+    ifstream in(path, ios::binary);
+    if (!in) return false;
+    copy.assign(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    data = copy.data();
+    length = copy.size();
+#endif
+
+    auto fail = [this]() {
+        close();
+        return false;
+    };
+    if (length < HeaderSize || memcmp(data, Magic, sizeof(Magic)) != 0) return fail();
+    if (load<uint32_t>(data + 4) != Version || load<uint64_t>(data + 8) != fingerprint) return fail();
+    uint64_t routes = load<uint64_t>(data + 16), payloadBytes = load<uint64_t>(data + 24);
+    // Column sizes must add up to the file size exactly (guards against truncation and overflow).
+    const uint64_t perRoute = sizeof(int32_t) + sizeof(uint32_t) + sizeof(uint64_t);
+    uint64_t body = length - HeaderSize;
+    if (routes > body / perRoute || body - routes * perRoute < sizeof(uint64_t) ||
+        payloadBytes != body - routes * perRoute - sizeof(uint64_t))
+        return fail();
+
+    count = static_cast<size_t>(routes);
+    startColumn = data + HeaderSize;
+    hopColumn = startColumn + count * sizeof(int32_t);
+    offsetColumn = hopColumn + count * sizeof(uint32_t);
+    payload = offsetColumn + (count + 1) * sizeof(uint64_t);
+    if (load<uint64_t>(offsetColumn + count * sizeof(uint64_t)) != payloadBytes) return fail();
+    return true;
+}
+
+int32_t PathArchiveFile::start(size_t id) const { return load<int32_t>(startColumn + id * sizeof(int32_t)); }
+
+uint32_t PathArchiveFile::hops(size_t id) const { return load<uint32_t>(hopColumn + id * sizeof(uint32_t)); }
+
+string_view PathArchiveFile::bits(size_t id) const {
+    uint64_t first = load<uint64_t>(offsetColumn + id * sizeof(uint64_t));
+    uint64_t last = load<uint64_t>(offsetColumn + (id + 1) * sizeof(uint64_t));
+    uint64_t total = load<uint64_t>(offsetColumn + count * sizeof(uint64_t));
+    if (first > last || last > total) return {};
+    return string_view(payload + first, static_cast<size_t>(last - first));
+}
@@ -0,0 +1,133 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "FrozenGraph.h"
+using namespace std;
+
+// Graph-independent path encoding: the vertex count, then the zigzag delta of
+// each vertex to the previous one as a LEB128 varint (integral vertex types).
+// Nearby vertex ids cost one or two bytes per hop.
+template<typename VertexType>
+void append_path_delta(const vector<VertexType>& path, string& out);
+// Reads a path written by append_path_delta at `pos` and advances it; false if truncated.
+template<typename VertexType>
+bool read_path_delta(string_view in, size_t& pos, vector<VertexType>& path);
+
+// Path encoding relative to a FrozenGraph: the start vertex index, the hop count
+// and, for every hop, the position of the next vertex in the current vertex's
+// adjacency, in ceil(log2(degree)) bits (nothing at all for degree 1). Road
+// networks have degree <= 4 almost everywhere, so a hop takes about two bits.
+//
+// The codec is only valid for the graph it was made for; PathArchive checks this
+// with a fingerprint of the adjacency arrays and vertex labels.
+template<typename VertexType>
+class PathCodec {
+public:
+    explicit PathCodec(const FrozenGraph<VertexType>& g);
+
+    const FrozenGraph<VertexType>& graph() const { return g; }
+    uint64_t fingerprint() const { return graphFingerprint; }
+
+    // Self-contained form: varint (start index + 1, 0 for an empty path), varint
+    // hop count, hop bits. False if a vertex is unknown or two consecutive
+    // vertices are not adjacent; `out` is then left unchanged.
+    bool encode(const vector<VertexType>& path, string& out) const;
+    // Decodes one path at `pos` and advances it; false on corrupt input.
+    bool decode(string_view in, size_t& pos, vector<VertexType>& path) const;
+
+    // Hop bits only (PathArchive keeps start and hop count in their own columns).
+    // start is -1 for an empty path.
+    bool encodeHops(const vector<VertexType>& path, int& start, uint32_t& hops, string& bits) const;
+    bool decodeHops(int start, uint32_t hops, string_view bits, vector<VertexType>& path) const;
+
+private:
+    // Follows `hops` hops from vertex index `start`; bitCount is set to the bits consumed.
+    bool walk(int start, uint64_t hops, string_view bits, vector<VertexType>& path, uint64_t& bitCount) const;
+
+    const FrozenGraph<VertexType>& g;
+    vector<uint8_t> hopBits; // per vertex index
+    uint64_t graphFingerprint;
+};
+
+// Columnar file of encoded paths with random access by route id.
+//
+// Layout (native byte order): "PARC" | u32 version | u64 graph fingerprint |
+// u64 route count | u64 payload bytes | i32 start[count] | u32 hops[count] |
+// u64 payloadOffset[count + 1] | payload. The fixed-width columns give the
+// start vertex, length and hop bits of any route without touching the others.
+template<typename VertexType>
+class PathArchiveWriter {
+public:
+    explicit PathArchiveWriter(const PathCodec<VertexType>& codec) : codec(codec) {}
+
+    // Route id of the added path, or -1 if it is not a path of the codec's graph.
+    long long add(const vector<VertexType>& path);
+    size_t size() const { return starts.size(); }
+    size_t payloadBytes() const { return payload.size(); }
+    bool write(const string& path) const;
+
+private:
+    const PathCodec<VertexType>& codec;
+    vector<int32_t> starts;
+    vector<uint32_t> hops;
+    vector<uint64_t> offsets{ 0 };
+    string payload;
+};
+
+// Read side of the archive; the file is mapped (read into memory where mmap is
+// not available), so opening costs nothing per route.
+class PathArchiveFile {
+public:
+    PathArchiveFile() = default;
+    ~PathArchiveFile();
+    PathArchiveFile(const PathArchiveFile&) = delete;
+    PathArchiveFile& operator=(const PathArchiveFile&) = delete;
+
+    // False if the file is missing, malformed or was written for another graph.
+    bool open(const string& path, uint64_t fingerprint);
+    void close();
+
+    size_t size() const { return count; }
+    int32_t start(size_t id) const;
+    uint32_t hops(size_t id) const;
+    string_view bits(size_t id) const;
+
+    static bool write(const string& path, uint64_t fingerprint, const vector<int32_t>& starts,
+        const vector<uint32_t>& hops, const vector<uint64_t>& offsets, const string& payload);
+
+private:
+    const char* data = nullptr;
+    size_t length = 0;
+    void* mapping = nullptr;
+    string copy;
+    size_t count = 0;
+    const char* startColumn = nullptr;
+    const char* hopColumn = nullptr;
+    const char* offsetColumn = nullptr;
+    const char* payload = nullptr;
+};
+
+template<typename VertexType>
+class PathArchive {
+public:
+    explicit PathArchive(const PathCodec<VertexType>& codec) : codec(codec) {}
+
+    bool open(const string& path) { return file.open(path, codec.fingerprint()); }
+    void close() { file.close(); }
+
+    size_t size() const { return file.size(); }
+    // Hops of route `id`; 0 if the id is out of range.
+    size_t hopCount(size_t id) const { return id < file.size() ? file.hops(id) : 0; }
+    // Decodes route `id`; false if the id is out of range or the data is corrupt.
+    bool get(size_t id, vector<VertexType>& path) const;
+    vector<VertexType> get(size_t id) const;
+
+private:
+    const PathCodec<VertexType>& codec;
+    PathArchiveFile file;
+};
+
+#include "PathCodec.inl"
@@ -0,0 +1,256 @@
+#include "PathCodec.h"
+
+namespace path_codec_detail {
+    inline void putVarint(string& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    inline bool getVarint(string_view in, size_t& pos, uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            uint8_t b = static_cast<uint8_t>(in[pos++]);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80)) return true;
+        }
+        return false;
+    }
+
+    // LSB-first bit packing.
+    class BitWriter {
+    public:
+        explicit BitWriter(string& out) : out(out) {}
+        void put(uint32_t value, int bits) {
+            buffer |= static_cast<uint64_t>(value) << used;
+            used += bits;
+            while (used >= 8) {
+                out.push_back(static_cast<char>(buffer));
+                buffer >>= 8;
+                used -= 8;
+            }
+        }
+        void flush() {
+            if (used > 0) out.push_back(static_cast<char>(buffer));
+            buffer = 0;
+            used = 0;
+        }
+    private:
+        string& out;
+        uint64_t buffer = 0;
+        int used = 0;
+    };
+
+    class BitReader {
+    public:
+        explicit BitReader(string_view in)
+            : p(reinterpret_cast<const uint8_t*>(in.data())), end(p + in.size()) {}
+        // False once more bits are requested than the input holds.
+        bool get(int bits, uint32_t& value) {
+            if (available < bits) refill();
+            if (available < bits) return false;
+            value = static_cast<uint32_t>(buffer & ((uint64_t(1) << bits) - 1));
+            buffer >>= bits;
+            available -= bits;
+            return true;
+        }
+    private:
+        void refill() {
+            while (available <= 56 && p < end) {
+                buffer |= static_cast<uint64_t>(*p++) << available;
+                available += 8;
+            }
+        }
+        const uint8_t* p;
+        const uint8_t* end;
+        uint64_t buffer = 0;
+        int available = 0;
+    };
+
+    inline int bitsFor(int degree) {
+        int bits = 0;
+        while ((1LL << bits) < degree) bits++;
+        return bits;
+    }
+}
+
+template<typename VertexType>
+void append_path_delta(const vector<VertexType>& path, string& out) {
+    static_assert(is_integral_v<VertexType>, "delta encoding needs integral vertex ids");
+    path_codec_detail::putVarint(out, path.size());
+    long long previous = 0;
+    for (VertexType v : path) {
+        long long delta = static_cast<long long>(v) - previous;
+        previous = static_cast<long long>(v);
+        path_codec_detail::putVarint(out, (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63));
+    }
+}
+
+template<typename VertexType>
+bool read_path_delta(string_view in, size_t& pos, vector<VertexType>& path) {
+    static_assert(is_integral_v<VertexType>, "delta encoding needs integral vertex ids");
+    uint64_t count;
+    if (!path_codec_detail::getVarint(in, pos, count) || count > in.size() - pos) return false;
+    path.clear();
+    path.reserve(static_cast<size_t>(count));
+    long long previous = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t z;
+        if (!path_codec_detail::getVarint(in, pos, z)) return false;
+        previous += static_cast<long long>(z >> 1) ^ -static_cast<long long>(z & 1);
+        path.push_back(static_cast<VertexType>(previous));
+    }
+    return true;
+}
+
+template<typename VertexType>
+PathCodec<VertexType>::PathCodec(const FrozenGraph<VertexType>& graph) : g(graph) {
+    auto const& offsets = g.getOffsets();
+    auto const& targets = g.getTargets();
+    int n = g.vertex_count();
+    hopBits.resize(n);
+    for (int u = 0; u < n; u++) hopBits[u] = static_cast<uint8_t>(path_codec_detail::bitsFor(offsets[u + 1] - offsets[u]));
+    // FNV-1a over the adjacency structure and the vertex labels (integral or
+    // string ones), so a renumbered graph of the same shape does not match.
+    uint64_t h = 1469598103934665603ULL;
+    auto mix = [&h](uint64_t v) {
+        h ^= v;
+        h *= 1099511628211ULL;
+    };
+    mix(static_cast<uint64_t>(n));
+    for (int u = 0; u <= n; u++) mix(static_cast<uint64_t>(offsets[u]));
+    for (size_t e = 0; e < targets.size(); e++) mix(static_cast<uint64_t>(targets[e]));
+    for (int u = 0; u < n; u++) {
+        if constexpr (is_integral_v<VertexType>) {
+            mix(static_cast<uint64_t>(g.vertex_at(u)));
+        } else if constexpr (is_same_v<VertexType, string>) {
+            for (char c : g.vertex_at(u)) mix(static_cast<uint8_t>(c));
+            mix(g.vertex_at(u).size());
+        }
+    }
+    graphFingerprint = h;
+}
+
+template<typename VertexType>
+bool PathCodec<VertexType>::encodeHops(const vector<VertexType>& path, int& start, uint32_t& hops, string& bits) const {
+    start = -1;
+    hops = 0;
+    if (path.empty()) return true;
+    int u = g.index_of(path[0]);
+    if (u < 0) return false;
+    auto const& offsets = g.getOffsets();
+    auto const& targets = g.getTargets();
+    size_t mark = bits.size();
+    path_codec_detail::BitWriter writer(bits);
+    int current = u;
+    for (size_t i = 1; i < path.size(); i++) {
+        int position = -1;
+        for (int e = offsets[current]; e < offsets[current + 1]; e++) {
+            if (g.vertex_at(targets[e]) == path[i]) {
+                position = e - offsets[current];
+                break;
+            }
+        }
+        if (position < 0) {
+            bits.resize(mark);
+            return false;
+        }
+        writer.put(static_cast<uint32_t>(position), hopBits[current]);
+        current = targets[offsets[current] + position];
+    }
+    writer.flush();
+    start = u;
+    hops = static_cast<uint32_t>(path.size() - 1);
+    return true;
+}
+
+template<typename VertexType>
+bool PathCodec<VertexType>::walk(int start, uint64_t hops, string_view bits, vector<VertexType>& path, uint64_t& bitCount) const {
+    auto const& offsets = g.getOffsets();
+    auto const& targets = g.getTargets();
+    path.clear();
+    path.reserve(static_cast<size_t>(min<uint64_t>(hops, bits.size() * 8 + 1)) + 1);
+    path.push_back(g.vertex_at(start));
+    path_codec_detail::BitReader reader(bits);
+    int current = start;
+    bitCount = 0;
+    for (uint64_t i = 0; i < hops; i++) {
+        uint32_t position = 0;
+        if (!reader.get(hopBits[current], position)) return false;
+        bitCount += hopBits[current];
+        if (static_cast<int>(position) >= offsets[current + 1] - offsets[current]) return false;
+        current = targets[offsets[current] + static_cast<int>(position)];
+        path.push_back(g.vertex_at(current));
+    }
+    return true;
+}
+
+template<typename VertexType>
+bool PathCodec<VertexType>::decodeHops(int start, uint32_t hops, string_view bits, vector<VertexType>& path) const {
+    if (start < 0 || start >= g.vertex_count()) {
+        path.clear();
+        return start < 0 && hops == 0;
+    }
+    uint64_t bitCount;
+    return walk(start, hops, bits, path, bitCount);
+}
+
+template<typename VertexType>
+bool PathCodec<VertexType>::encode(const vector<VertexType>& path, string& out) const {
+    int start;
+    uint32_t hops;
+    string bits;
+    if (!encodeHops(path, start, hops, bits)) return false;
+    path_codec_detail::putVarint(out, static_cast<uint64_t>(start + 1));
+    if (start < 0) return true;
+    path_codec_detail::putVarint(out, hops);
+    out += bits;
+    return true;
+}
+
+template<typename VertexType>
+bool PathCodec<VertexType>::decode(string_view in, size_t& pos, vector<VertexType>& path) const {
+    uint64_t start, hops;
+    if (!path_codec_detail::getVarint(in, pos, start)) return false;
+    if (start == 0) {
+        path.clear();
+        return true;
+    }
+    if (!path_codec_detail::getVarint(in, pos, hops) || start > static_cast<uint64_t>(g.vertex_count())) return false;
+    // The bits of a path are byte-aligned, so the next path starts at the next byte.
+    uint64_t bitCount;
+    if (!walk(static_cast<int>(start - 1), hops, in.substr(pos), path, bitCount)) return false;
+    pos += static_cast<size_t>((bitCount + 7) / 8);
+    return true;
+}
+
+template<typename VertexType>
+long long PathArchiveWriter<VertexType>::add(const vector<VertexType>& path) {
+    int start;
+    uint32_t hopCount;
+    if (!codec.encodeHops(path, start, hopCount, payload)) return -1;
+    starts.push_back(start);
+    hops.push_back(hopCount);
+    offsets.push_back(payload.size());
+    return static_cast<long long>(starts.size()) - 1;
+}
+
+template<typename VertexType>
+bool PathArchiveWriter<VertexType>::write(const string& path) const {
+    return PathArchiveFile::write(path, codec.fingerprint(), starts, hops, offsets, payload);
+}
+
+template<typename VertexType>
+bool PathArchive<VertexType>::get(size_t id, vector<VertexType>& path) const {
+    if (id >= file.size()) return false;
+    return codec.decodeHops(file.start(id), file.hops(id), file.bits(id), path);
+}
+
+template<typename VertexType>
+vector<VertexType> PathArchive<VertexType>::get(size_t id) const {
+    vector<VertexType> path;
+    if (!get(id, path)) path.clear();
+    return path;
+}
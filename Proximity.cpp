@@ -0,0 +1,201 @@
+#include "Proximity.h"
+#include <algorithm>
+#include <cmath>
+#include "Trace.h"
+using namespace std;
+
+namespace {
+    // Cells per axis are capped so that cy * cols + cx always fits in 64 bits.
+    constexpr double MaxCellsPerAxis = 1u << 30;
+
+    // LSD radix sort of keys (carrying ids) by bytes; a byte that is the same for
+    // every key would be a no-op pass and is skipped.
+    void radixSort(vector<uint64_t>& keys, vector<int>& ids, vector<uint64_t>& keyScratch, vector<int>& idScratch) {
+        size_t n = keys.size();
+        if (n < 2) return;
+        vector<size_t> counts(8 * 256, 0);
+        for (uint64_t k : keys)
+            for (int b = 0; b < 8; b++) counts[b * 256 + ((k >> (8 * b)) & 0xFF)]++;
+
+        keyScratch.resize(n);
+        idScratch.resize(n);
+        for (int b = 0; b < 8; b++) {
+            size_t* count = &counts[b * 256];
+            if (count[(keys[0] >> (8 * b)) & 0xFF] == n) continue;
+            size_t sum = 0;
+            for (int d = 0; d < 256; d++) {
+                size_t c = count[d];
+                count[d] = sum;
+                sum += c;
+            }
+            for (size_t i = 0; i < n; i++) {
+                size_t pos = count[(keys[i] >> (8 * b)) & 0xFF]++;
+                keyScratch[pos] = keys[i];
+                idScratch[pos] = ids[i];
+            }
+            keys.swap(keyScratch);
+            ids.swap(idScratch);
+        }
+    }
+}
+
+ProximityDetector::ProximityDetector(double radius) : radius(radius > 0 ? radius : 0) {}
+
+void ProximityDetector::growBounds(const vector<double>& xs, const vector<double>& ys, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        minX = min(minX, xs[i]);
+        minY = min(minY, ys[i]);
+        maxX = max(maxX, xs[i]);
+        maxY = max(maxY, ys[i]);
+    }
+}
+
+void ProximityDetector::setupCells() {
+    // A cell at least `radius` wide means close points are at most one cell apart.
+    double extent = max(maxX - minX, maxY - minY);
+    cellSize = max(radius, extent / MaxCellsPerAxis);
+    if (cellSize <= 0) cellSize = 1;
+    cols = static_cast<uint64_t>((maxX - minX) / cellSize) + 1;
+}
+
+uint64_t ProximityDetector::cellX(double px) const {
+    return min(static_cast<uint64_t>((px - minX) / cellSize), cols - 1);
+}
+
+uint64_t ProximityDetector::cellY(double py) const {
+    return static_cast<uint64_t>((py - minY) / cellSize);
+}
+
+void ProximityDetector::fill(Grid& grid, const vector<double>& xs, const vector<double>& ys, size_t n) {
+    grid.keys.resize(n);
+    grid.ids.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        grid.keys[i] = cellY(ys[i]) * cols + cellX(xs[i]);
+        grid.ids[i] = static_cast<int>(i);
+    }
+    radixSort(grid.keys, grid.ids, keyScratch, idScratch);
+
+    // Coordinates in sorted order, so every cell run is contiguous for the narrow phase.
+    grid.xs.resize(n);
+    grid.ys.resize(n);
+    for (size_t i = 0; i < n; i++) {
+        grid.xs[i] = xs[grid.ids[i]];
+        grid.ys[i] = ys[grid.ids[i]];
+    }
+}
+
+template<typename Emit>
+void ProximityDetector::narrow(const Grid& grid, size_t begin, size_t end, double px, double py, Emit&& emit) {
+    if (begin >= end) return;
+    size_t count = end - begin;
+    if (distScratch.size() < count) distScratch.resize(count);
+    const double* xs = grid.xs.data() + begin;
+    const double* ys = grid.ys.data() + begin;
+    double* d2 = distScratch.data();
+    for (size_t i = 0; i < count; i++) {
+        double dx = xs[i] - px, dy = ys[i] - py;
+        d2[i] = dx * dx + dy * dy;
+    }
+    const double r2 = radius * radius;
+    for (size_t i = 0; i < count; i++)
+        if (d2[i] <= r2) emit(begin + i, sqrt(d2[i]));
+}
+
+const vector<ProximityPair>& ProximityDetector::findClosePairs(const FleetPositions& fleet) {
+    TRACE_SCOPE("simulation", "proximity_pairs");
+    pairs.clear();
+    size_t n = min(fleet.x.size(), fleet.y.size());
+    if (n < 2) return pairs;
+
+    minX = minY = numeric_limits<double>::infinity();
+    maxX = maxY = -numeric_limits<double>::infinity();
+    growBounds(fleet.x, fleet.y, n);
+    setupCells();
+    fill(vehicles, fleet.x, fleet.y, n);
+
+    const vector<uint64_t>& keys = vehicles.keys;
+    const vector<int>& ids = vehicles.ids;
+    size_t runStart = 0;
+    while (runStart < n) {
+        uint64_t key = keys[runStart];
+        uint64_t cx = key % cols;
+        size_t runEnd = runStart;
+        while (runEnd < n && keys[runEnd] == key) runEnd++;
+
+        // Forward neighbors only: the cell to the right (adjacent in key order, so it
+        // extends this run) and the three cells of the next row (one contiguous key range).
+        size_t rightEnd = runEnd;
+        if (cx + 1 < cols)
+            while (rightEnd < n && keys[rightEnd] == key + 1) rightEnd++;
+        uint64_t aboveLo = key + cols - (cx > 0 ? 1 : 0);
+        uint64_t aboveHi = key + cols + (cx + 1 < cols ? 1 : 0);
+        size_t aboveBegin = lower_bound(keys.begin() + rightEnd, keys.end(), aboveLo) - keys.begin();
+        size_t aboveEnd = upper_bound(keys.begin() + aboveBegin, keys.end(), aboveHi) - keys.begin();
+
+        for (size_t s = runStart; s < runEnd; s++) {
+            auto emit = [&](size_t t, double d) {
+                int a = ids[s], b = ids[t];
+                if (a > b) swap(a, b);
+                pairs.push_back({ a, b, d });
+            };
+            double px = vehicles.xs[s], py = vehicles.ys[s];
+            narrow(vehicles, s + 1, rightEnd, px, py, emit);
+            narrow(vehicles, aboveBegin, aboveEnd, px, py, emit);
+        }
+        runStart = runEnd;
+    }
+    return pairs;
+}
+
+const vector<ObstacleAlert>& ProximityDetector::findObstacleAlerts(const FleetPositions& fleet,
+    const vector<Obstacle>& obstacles) {
+    TRACE_SCOPE("simulation", "proximity_obstacles");
+    alerts.clear();
+    size_t n = min(fleet.x.size(), fleet.y.size());
+    size_t m = obstacles.size();
+    if (n == 0 || m == 0) return alerts;
+
+    obstacleX.resize(m);
+    obstacleY.resize(m);
+    for (size_t i = 0; i < m; i++) {
+        obstacleX[i] = obstacles[i].getX();
+        obstacleY[i] = obstacles[i].getY();
+    }
+
+    // Both sets share one cell grid; obstacles are bucketed, vehicles probe it.
+    minX = minY = numeric_limits<double>::infinity();
+    maxX = maxY = -numeric_limits<double>::infinity();
+    growBounds(fleet.x, fleet.y, n);
+    growBounds(obstacleX, obstacleY, m);
+    setupCells();
+    fill(obstacleGrid, obstacleX, obstacleY, m);
+    fill(vehicles, fleet.x, fleet.y, n);
+
+    // Vehicles are visited cell by cell, so the three obstacle row ranges are looked
+    // up once per cell and stay in cache for all of its vehicles.
+    const vector<uint64_t>& keys = obstacleGrid.keys;
+    size_t runStart = 0;
+    while (runStart < n) {
+        uint64_t key = vehicles.keys[runStart];
+        size_t runEnd = runStart;
+        while (runEnd < n && vehicles.keys[runEnd] == key) runEnd++;
+
+        uint64_t cx = key % cols, cy = key / cols;
+        uint64_t loX = cx > 0 ? cx - 1 : 0, hiX = min(cx + 1, cols - 1);
+        size_t begins[3], ends[3];
+        int rows = 0;
+        for (uint64_t row = (cy > 0 ? cy - 1 : 0); row <= cy + 1; row++, rows++) {
+            begins[rows] = lower_bound(keys.begin(), keys.end(), row * cols + loX) - keys.begin();
+            ends[rows] = upper_bound(keys.begin() + begins[rows], keys.end(), row * cols + hiX) - keys.begin();
+        }
+
+        for (size_t s = runStart; s < runEnd; s++) {
+            int vehicle = vehicles.ids[s];
+            auto emit = [&](size_t t, double d) { alerts.push_back({ vehicle, obstacleGrid.ids[t], d }); };
+            for (int r = 0; r < rows; r++)
+                narrow(obstacleGrid, begins[r], ends[r], vehicles.xs[s], vehicles.ys[s], emit);
+        }
+        runStart = runEnd;
+    }
+    return alerts;
+}
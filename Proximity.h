@@ -0,0 +1,84 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "Environment.h"
+using namespace std;
+
+// Vehicle positions for one simulation tick, stored as separate coordinate arrays.
+struct FleetPositions {
+    vector<double> x;
+    vector<double> y;
+
+    void add(double px, double py) {
+        x.push_back(px);
+        y.push_back(py);
+    }
+    size_t size() const { return x.size(); }
+    void clear() {
+        x.clear();
+        y.clear();
+    }
+};
+
+struct ProximityPair {
+    int a; // vehicle indices, a < b
+    int b;
+    double distance;
+};
+
+struct ObstacleAlert {
+    int vehicle;
+    int obstacle; // index into the obstacle list
+    double distance;
+};
+
+// Per-tick proximity alerts (vehicle-vehicle and vehicle-Obstacle) without the
+// O(N^2) all-pairs check.
+//
+// Broad phase: positions are mapped to grid cells at least `radius` wide and the
+// cell keys (row * cols + column) are radix sorted, so each cell is a contiguous
+// run. A cell is only compared with itself and its forward neighbors, so every
+// pair is found once. Narrow phase: squared distances to a whole run are computed
+// in a branch-free loop the compiler vectorizes, then filtered.
+// Buffers are reused between ticks; results stay valid until the next call.
+class ProximityDetector {
+public:
+    explicit ProximityDetector(double radius);
+
+    double getRadius() const { return radius; }
+
+    // Vehicle pairs within the radius, in no particular order.
+    const vector<ProximityPair>& findClosePairs(const FleetPositions& fleet);
+
+    // (vehicle, obstacle) pairs within the radius, in no particular order.
+    const vector<ObstacleAlert>& findObstacleAlerts(const FleetPositions& fleet, const vector<Obstacle>& obstacles);
+
+private:
+    struct Grid {
+        vector<uint64_t> keys; // sorted cell keys
+        vector<int> ids;       // original index of each sorted slot
+        vector<double> xs, ys; // coordinates of each sorted slot
+    };
+
+    void growBounds(const vector<double>& xs, const vector<double>& ys, size_t n);
+    void setupCells();
+    uint64_t cellX(double px) const;
+    uint64_t cellY(double py) const;
+    void fill(Grid& grid, const vector<double>& xs, const vector<double>& ys, size_t n);
+    // Calls emit(slot, distance) for slots [begin, end) of grid within the radius of (px, py).
+    template<typename Emit>
+    void narrow(const Grid& grid, size_t begin, size_t end, double px, double py, Emit&& emit);
+
+    double radius;
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    double cellSize = 1;
+    uint64_t cols = 1;
+    Grid vehicles, obstacleGrid;
+    vector<double> obstacleX, obstacleY;
+    vector<uint64_t> keyScratch;
+    vector<int> idScratch;
+    vector<double> distScratch;
+    vector<ProximityPair> pairs;
+    vector<ObstacleAlert> alerts;
+};
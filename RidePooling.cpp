@@ -0,0 +1,207 @@
+#include "RidePooling.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "Trace.h"
+using namespace std;
+
+namespace {
+    constexpr double Infinity = numeric_limits<double>::infinity();
+    constexpr double Epsilon = 1e-9; // tolerance for time comparisons
+
+    double distance(double ax, double ay, double bx, double by) {
+        return hypot(ax - bx, ay - by);
+    }
+
+    long long packCell(long long cx, long long cy) {
+        return static_cast<long long>((static_cast<unsigned long long>(cx) << 32) ^ (cy & 0xFFFFFFFFLL));
+    }
+}
+
+RidePooling::RidePooling(double cellSize) : cellSize(cellSize > 0 ? cellSize : 1.0) {}
+
+int RidePooling::addVehicle(const Transport& transport, double x, double y, double time, int capacity) {
+    Vehicle v;
+    v.transport = &transport;
+    v.x = x;
+    v.y = y;
+    v.time = time;
+    v.speed = transport.getSpeed();
+    v.capacity = capacity >= 0 ? capacity : transport.getCapacity();
+    vehicles.push_back(v);
+    gridDirty = true;
+    return static_cast<int>(vehicles.size()) - 1;
+}
+
+void RidePooling::updateVehicle(int vehicle, double x, double y, double time) {
+    Vehicle& v = vehicles[vehicle];
+    v.x = x;
+    v.y = y;
+    v.time = time;
+    v.speed = v.transport->getSpeed();
+    refresh(v);
+    gridDirty = true;
+}
+
+void RidePooling::completeNextStop(int vehicle) {
+    Vehicle& v = vehicles[vehicle];
+    if (v.stops.empty()) return;
+    const RideStop& stop = v.stops.front();
+    v.x = stop.x;
+    v.y = stop.y;
+    v.time = v.arrival.front();
+    v.onboard += stop.pickup ? 1 : -1;
+    v.stops.erase(v.stops.begin());
+    refresh(v);
+    gridDirty = true;
+}
+
+void RidePooling::refresh(Vehicle& v) {
+    size_t n = v.stops.size();
+    v.leg.resize(n);
+    v.arrival.resize(n);
+    v.slack.resize(n);
+    v.load.resize(n);
+    double px = v.x, py = v.y, t = v.time;
+    int load = v.onboard;
+    for (size_t k = 0; k < n; k++) {
+        const RideStop& s = v.stops[k];
+        v.leg[k] = distance(px, py, s.x, s.y);
+        t += v.speed > 0 ? v.leg[k] / v.speed : Infinity;
+        v.arrival[k] = t;
+        load += s.pickup ? 1 : -1;
+        v.load[k] = load;
+        px = s.x;
+        py = s.y;
+    }
+    double slack = Infinity;
+    for (size_t k = n; k-- > 0;) {
+        slack = min(slack, v.stops[k].deadline - v.arrival[k]);
+        v.slack[k] = slack;
+    }
+}
+
+long long RidePooling::cellKey(double x, double y) const {
+    long long cx = static_cast<long long>(floor(x / cellSize));
+    long long cy = static_cast<long long>(floor(y / cellSize));
+    return packCell(cx, cy);
+}
+
+void RidePooling::rebuildGrid() {
+    grid.clear();
+    maxSpeed = 0;
+    minTime = Infinity;
+    for (int i = 0; i < static_cast<int>(vehicles.size()); i++) {
+        const Vehicle& v = vehicles[i];
+        grid[cellKey(v.x, v.y)].push_back(i);
+        maxSpeed = max(maxSpeed, v.speed);
+        minTime = min(minTime, v.time);
+    }
+    gridDirty = false;
+}
+
+// All O(1) checks below rely on: inserting a detour of d km before stop k delays
+// stop k and every later stop by d / speed, which is allowed iff it is <= slack[k].
+void RidePooling::evaluate(int index, const RideRequest& r, RideInsertion& best) {
+    const Vehicle& v = vehicles[index];
+    if (v.capacity <= 0 || v.speed <= 0) return;
+    if (v.time + distance(v.x, v.y, r.pickupX, r.pickupY) / v.speed > r.latestPickup + Epsilon) return;
+
+    int n = static_cast<int>(v.stops.size());
+    toPickup.resize(n + 1);
+    toDropoff.resize(n + 1);
+    fromPickup.resize(n);
+    fromDropoff.resize(n);
+    for (int k = 0; k <= n; k++) {
+        double px = k == 0 ? v.x : v.stops[k - 1].x;
+        double py = k == 0 ? v.y : v.stops[k - 1].y;
+        toPickup[k] = distance(px, py, r.pickupX, r.pickupY);
+        toDropoff[k] = distance(px, py, r.dropoffX, r.dropoffY);
+    }
+    for (int k = 0; k < n; k++) {
+        fromPickup[k] = distance(r.pickupX, r.pickupY, v.stops[k].x, v.stops[k].y);
+        fromDropoff[k] = distance(r.dropoffX, r.dropoffY, v.stops[k].x, v.stops[k].y);
+    }
+    const double direct = distance(r.pickupX, r.pickupY, r.dropoffX, r.dropoffY);
+    const double speed = v.speed;
+
+    for (int i = 0; i <= n; i++) {
+        int loadBefore = i == 0 ? v.onboard : v.load[i - 1];
+        if (loadBefore + 1 > v.capacity) continue;
+        double departure = i == 0 ? v.time : v.arrival[i - 1];
+        double pickupTime = departure + toPickup[i] / speed;
+        if (pickupTime > r.latestPickup + Epsilon) continue;
+
+        // Drop-off right after the pickup.
+        double dropoffTime = pickupTime + direct / speed;
+        if (dropoffTime <= r.latestDropoff + Epsilon) {
+            double added = toPickup[i] + direct + (i < n ? fromDropoff[i] - v.leg[i] : 0);
+            if ((i == n || added / speed <= v.slack[i] + Epsilon) && added < best.addedDistance)
+                best = { index, i, i, added, pickupTime, dropoffTime };
+        }
+        if (i == n) continue;
+
+        // Drop-off later: stops i..j-1 are delayed by the pickup detour only.
+        double pickupDetour = toPickup[i] + fromPickup[i] - v.leg[i];
+        double pickupDelay = pickupDetour / speed;
+        if (pickupDelay > v.slack[i] + Epsilon) continue;
+        double rangeSlack = Infinity;
+        for (int j = i + 1; j <= n; j++) {
+            int k = j - 1;
+            rangeSlack = min(rangeSlack, v.stops[k].deadline - v.arrival[k]);
+            if (pickupDelay > rangeSlack + Epsilon) break;
+            if (v.load[k] + 1 > v.capacity) break;
+            dropoffTime = v.arrival[k] + pickupDelay + toDropoff[j] / speed;
+            if (dropoffTime > r.latestDropoff + Epsilon) continue;
+            double dropoffDetour = toDropoff[j] + (j < n ? fromDropoff[j] - v.leg[j] : 0);
+            double added = pickupDetour + dropoffDetour;
+            if (j < n && added / speed > v.slack[j] + Epsilon) continue;
+            if (added < best.addedDistance) best = { index, i, j, added, pickupTime, dropoffTime };
+        }
+    }
+}
+
+RideInsertion RidePooling::findBestInsertion(const RideRequest& request) {
+    TRACE_SCOPE("simulation", "ride_insertion");
+    RideInsertion best;
+    best.addedDistance = Infinity;
+    if (gridDirty) rebuildGrid();
+    if (vehicles.empty() || maxSpeed <= 0) return RideInsertion();
+
+    // Only vehicles within the distance the fastest vehicle covers by the pickup deadline.
+    double reach = (request.latestPickup - minTime) * maxSpeed;
+    if (reach < 0) return RideInsertion();
+    double span = ceil(reach / cellSize);
+    if ((2 * span + 1) * (2 * span + 1) >= static_cast<double>(grid.size())) {
+        for (int i = 0; i < static_cast<int>(vehicles.size()); i++) evaluate(i, request, best);
+    }
+    else {
+        long long cx = static_cast<long long>(floor(request.pickupX / cellSize));
+        long long cy = static_cast<long long>(floor(request.pickupY / cellSize));
+        long long r = static_cast<long long>(span);
+        for (long long x = cx - r; x <= cx + r; x++) {
+            for (long long y = cy - r; y <= cy + r; y++) {
+                auto it = grid.find(packCell(x, y));
+                if (it == grid.end()) continue;
+                for (int i : it->second) evaluate(i, request, best);
+            }
+        }
+    }
+    return best.feasible() ? best : RideInsertion();
+}
+
+void RidePooling::commit(const RideRequest& request, const RideInsertion& insertion) {
+    if (!insertion.feasible()) return;
+    Vehicle& v = vehicles[insertion.vehicle];
+    RideStop pickup = { request.id, true, request.pickupX, request.pickupY, request.latestPickup };
+    RideStop dropoff = { request.id, false, request.dropoffX, request.dropoffY, request.latestDropoff };
+    v.stops.insert(v.stops.begin() + insertion.dropoffIndex, dropoff);
+    v.stops.insert(v.stops.begin() + insertion.pickupIndex, pickup);
+    refresh(v);
+}
+
+RideInsertion RidePooling::assign(const RideRequest& request) {
+    RideInsertion insertion = findBestInsertion(request);
+    commit(request, insertion);
+    return insertion;
+}
@@ -0,0 +1,101 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "Transport.h"
+using namespace std;
+
+// A shared-ride request: pickup and drop-off points (km) with latest times (hours).
+struct RideRequest {
+    int id;
+    double pickupX, pickupY;
+    double dropoffX, dropoffY;
+    double latestPickup;
+    double latestDropoff;
+};
+
+struct RideStop {
+    int requestId;
+    bool pickup;
+    double x, y;
+    double deadline;
+};
+
+// Where a request goes into a vehicle's stop list. The pickup is inserted before
+// stop pickupIndex and the drop-off before stop dropoffIndex of the current list
+// (dropoffIndex >= pickupIndex; equal means the drop-off directly follows the pickup).
+struct RideInsertion {
+    int vehicle = -1;
+    int pickupIndex = 0;
+    int dropoffIndex = 0;
+    double addedDistance = 0; // km added to the vehicle's remaining route
+    double pickupTime = 0;
+    double dropoffTime = 0;
+
+    bool feasible() const { return vehicle >= 0; }
+};
+
+// Insertion heuristic for dynamic ride pooling.
+//
+// Every vehicle keeps its planned stops together with cached per-stop values: the
+// length of the leg leading to the stop, the planned arrival, the occupancy after
+// it and the slack (how much later the vehicle may arrive there, and at every
+// following stop, without missing a deadline). Distances from the new pickup and
+// drop-off to the route stops are computed once per vehicle, so each (pickup,
+// drop-off) position pair is checked for time windows and capacity in O(1).
+// Vehicles that cannot reach the pickup in time even on a straight line are
+// pruned by a uniform grid over their positions.
+//
+// Distances are Euclidean in km, speeds come from Transport::getSpeed (km/h) and
+// capacity from Transport::getCapacity. Vehicles never wait at a stop.
+class RidePooling {
+public:
+    explicit RidePooling(double cellSize = 5.0);
+
+    // The vehicle is at (x, y) at `time`. capacity < 0 takes transport.getCapacity().
+    int addVehicle(const Transport& transport, double x, double y, double time = 0, int capacity = -1);
+    int vehicleCount() const { return static_cast<int>(vehicles.size()); }
+
+    // New position of a vehicle (e.g. after Transport::move); planned arrivals are
+    // recomputed from there.
+    void updateVehicle(int vehicle, double x, double y, double time);
+    // The vehicle reached its next stop: the stop is removed and the vehicle placed there.
+    void completeNextStop(int vehicle);
+
+    const vector<RideStop>& getStops(int vehicle) const { return vehicles[vehicle].stops; }
+    int getOnboard(int vehicle) const { return vehicles[vehicle].onboard; }
+
+    // Cheapest feasible insertion over all vehicles (vehicle == -1 if none).
+    RideInsertion findBestInsertion(const RideRequest& request);
+    // Applies an insertion returned by findBestInsertion.
+    void commit(const RideRequest& request, const RideInsertion& insertion);
+    // findBestInsertion + commit when feasible.
+    RideInsertion assign(const RideRequest& request);
+
+private:
+    struct Vehicle {
+        const Transport* transport;
+        double x, y, time;
+        double speed;
+        int capacity;
+        int onboard = 0;
+        vector<RideStop> stops;
+        // Cached per stop k (recomputed in refresh):
+        vector<double> leg;     // distance from the previous stop (or the vehicle) to k
+        vector<double> arrival; // planned arrival at k
+        vector<double> slack;   // min over m >= k of deadline[m] - arrival[m]
+        vector<int> load;       // passengers on board after k
+    };
+
+    void refresh(Vehicle& v);
+    void evaluate(int index, const RideRequest& request, RideInsertion& best);
+    long long cellKey(double x, double y) const;
+    void rebuildGrid();
+
+    double cellSize;
+    vector<Vehicle> vehicles;
+    unordered_map<long long, vector<int>> grid; // cell -> vehicles
+    bool gridDirty = true;
+    double maxSpeed = 0;
+    double minTime = 0; // earliest vehicle time, bounds the search radius
+    vector<double> toPickup, fromPickup, toDropoff, fromDropoff; // per-vehicle scratch
+};
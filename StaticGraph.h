@@ -0,0 +1,184 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include "Graph.h"
+using namespace std;
+
+// Fixed-capacity graph usable in constant expressions, for small networks known
+// at build time. Vertices are 0..vertex_count()-1. Routing tables and MSTs are
+// computed by constexpr functions, so
+//
+//     constexpr auto table = all_pairs_routing(network);
+//
+// is evaluated by the compiler and a route query at run time is a table lookup.
+template<size_t MaxVertices, size_t MaxEdges>
+class StaticGraph {
+public:
+    struct Edge {
+        int from = 0;
+        int to = 0;
+        int weight = 0;
+    };
+
+    constexpr StaticGraph(size_t vertices, bool isDirected = false) : vertexCount(vertices), directed(isDirected) {
+        if (vertices > MaxVertices) throw out_of_range("StaticGraph: too many vertices");
+    }
+
+    // Stored once; undirected edges are used in both directions.
+    constexpr void add_edge(int u, int v, int weight = 1) {
+        if (edgeCount == MaxEdges) throw out_of_range("StaticGraph: edge capacity exceeded");
+        if (u < 0 || v < 0 || static_cast<size_t>(u) >= vertexCount || static_cast<size_t>(v) >= vertexCount)
+            throw out_of_range("StaticGraph: vertex out of range");
+        edges[edgeCount++] = { u, v, weight };
+    }
+
+    constexpr size_t vertex_count() const { return vertexCount; }
+    constexpr size_t edge_count() const { return edgeCount; }
+    constexpr bool isDirected() const { return directed; }
+    constexpr const Edge& edge(size_t i) const { return edges[i]; }
+
+    static constexpr size_t capacity() { return MaxVertices; }
+
+    // Runtime copy as a regular Graph.
+    Graph<int> to_graph() const {
+        Graph<int> g(directed);
+        for (size_t v = 0; v < vertexCount; v++) g.add_vertex(static_cast<int>(v));
+        for (size_t i = 0; i < edgeCount; i++) g.add_edge(edges[i].from, edges[i].to, edges[i].weight);
+        return g;
+    }
+
+private:
+    array<Edge, MaxEdges> edges{};
+    size_t edgeCount = 0;
+    size_t vertexCount;
+    bool directed;
+};
+
+// All-pairs distances and next hops; -1 marks "unreachable".
+template<size_t N>
+struct RoutingTable {
+    array<array<int, N>, N> dist{};
+    array<array<int, N>, N> nextHop{};
+
+    constexpr int distance(int from, int to) const { return dist[from][to]; }
+    constexpr int next_hop(int from, int to) const { return nextHop[from][to]; }
+
+    // Path from -> to by following next hops (empty if unreachable).
+    vector<int> route(int from, int to) const {
+        vector<int> path;
+        if (dist[from][to] < 0) return path;
+        for (int v = from; v != to; v = nextHop[v][to])
+            path.push_back(v);
+        path.push_back(to);
+        return path;
+    }
+};
+
+// Dijkstra from every vertex, O(V^2) per source with an array scan instead of a
+// heap (simpler in constant expressions and fast for the sizes this is meant for).
+template<size_t MaxVertices, size_t MaxEdges>
+constexpr RoutingTable<MaxVertices> all_pairs_routing(const StaticGraph<MaxVertices, MaxEdges>& g) {
+    const int INF = numeric_limits<int>::max();
+    const int n = static_cast<int>(g.vertex_count());
+    RoutingTable<MaxVertices> table{};
+    // Cells past vertex_count() stay unreachable, like any other missing route.
+    for (size_t i = 0; i < MaxVertices; i++)
+        for (size_t j = 0; j < MaxVertices; j++) {
+            table.dist[i][j] = -1;
+            table.nextHop[i][j] = -1;
+        }
+
+    for (int s = 0; s < n; s++) {
+        array<int, MaxVertices> dist{};
+        array<int, MaxVertices> firstHop{};
+        array<bool, MaxVertices> done{};
+        for (int v = 0; v < n; v++) {
+            dist[v] = INF;
+            firstHop[v] = -1;
+        }
+        dist[s] = 0;
+        firstHop[s] = s;
+
+        for (int round = 0; round < n; round++) {
+            int u = -1;
+            for (int v = 0; v < n; v++)
+                if (!done[v] && dist[v] != INF && (u < 0 || dist[v] < dist[u])) u = v;
+            if (u < 0) break;
+            done[u] = true;
+
+            for (size_t i = 0; i < g.edge_count(); i++) {
+                auto const& e = g.edge(i);
+                int to = -1;
+                if (e.from == u) to = e.to;
+                else if (!g.isDirected() && e.to == u) to = e.from;
+                if (to < 0 || done[to]) continue;
+                if (dist[u] + e.weight < dist[to]) {
+                    dist[to] = dist[u] + e.weight;
+                    firstHop[to] = u == s ? to : firstHop[u];
+                }
+            }
+        }
+
+        for (int v = 0; v < n; v++) {
+            table.dist[s][v] = dist[v] == INF ? -1 : dist[v];
+            table.nextHop[s][v] = firstHop[v];
+        }
+    }
+    return table;
+}
+
+// std::pair assignment is not constexpr before C++20.
+struct StaticTreeEdge {
+    int first = 0;
+    int second = 0;
+};
+
+template<size_t MaxVertices>
+struct StaticMST {
+    array<StaticTreeEdge, (MaxVertices > 0 ? MaxVertices - 1 : 0)> edges{};
+    size_t edgeCount = 0;
+    int totalWeight = 0;
+};
+
+// Kruskal with an insertion sort and an array union-find, both constexpr.
+// Like Graph::mst_kruskal it returns an empty result for directed graphs and a
+// spanning forest for disconnected ones.
+template<size_t MaxVertices, size_t MaxEdges>
+constexpr StaticMST<MaxVertices> mst_kruskal(const StaticGraph<MaxVertices, MaxEdges>& g) {
+    StaticMST<MaxVertices> mst{};
+    if (g.isDirected()) return mst;
+
+    array<size_t, MaxEdges> order{};
+    for (size_t i = 0; i < g.edge_count(); i++) order[i] = i;
+    for (size_t i = 1; i < g.edge_count(); i++) {
+        size_t cur = order[i];
+        size_t j = i;
+        for (; j > 0 && g.edge(order[j - 1]).weight > g.edge(cur).weight; j--)
+            order[j] = order[j - 1];
+        order[j] = cur;
+    }
+
+    array<int, MaxVertices> parent{};
+    for (size_t v = 0; v < g.vertex_count(); v++) parent[v] = static_cast<int>(v);
+    auto find = [&parent](int v) {
+        while (parent[v] != v) {
+            parent[v] = parent[parent[v]];
+            v = parent[v];
+        }
+        return v;
+    };
+
+    for (size_t i = 0; i < g.edge_count(); i++) {
+        auto const& e = g.edge(order[i]);
+        if (e.from == e.to) continue;
+        int a = find(e.from), b = find(e.to);
+        if (a == b) continue;
+        parent[a] = b;
+        mst.edges[mst.edgeCount++] = { e.from, e.to };
+        mst.totalWeight += e.weight;
+    }
+    return mst;
+}
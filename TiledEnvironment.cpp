@@ -0,0 +1,340 @@
+#include "TiledEnvironment.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <queue>
+#include "Trace.h"
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// File layout (native byte order):
+//   "TENV" | u32 version | f64 tileSize | u32 tileCount
+//   tileCount x { i32 tx | i32 ty | u64 offset | u64 size }
+//   tile blocks: u32 routeCount | u32 obstacleCount | routes | obstacles
+//   route:    start (name, x, y) | destination (name, x, y) | f64 distance
+//   obstacle: description | f64 x | f64 y
+//   string:   u32 length | bytes
+namespace {
+    const char Magic[4] = { 'T', 'E', 'N', 'V' };
+    constexpr uint32_t Version = 1;
+    constexpr size_t EntrySize = 2 * sizeof(int32_t) + 2 * sizeof(uint64_t);
+
+    long long packTile(long long tx, long long ty) {
+        return static_cast<long long>((static_cast<unsigned long long>(tx) << 32) ^ (ty & 0xFFFFFFFFLL));
+    }
+
+    struct BlobWriter {
+        string data;
+        template<typename T>
+        void put(T value) { data.append(reinterpret_cast<const char*>(&value), sizeof(T)); }
+        void putString(const string& s) {
+            put<uint32_t>(static_cast<uint32_t>(s.size()));
+            data += s;
+        }
+        void putPoint(const Point& p) {
+            putString(p.getName());
+            put<double>(p.getX());
+            put<double>(p.getY());
+        }
+    };
+
+    struct BlobReader {
+        const char* pos;
+        const char* end;
+        template<typename T>
+        bool get(T& value) {
+            if (end - pos < static_cast<ptrdiff_t>(sizeof(T))) return false;
+            memcpy(&value, pos, sizeof(T));
+            pos += sizeof(T);
+            return true;
+        }
+        bool getString(string& s) {
+            uint32_t length;
+            if (!get(length) || end - pos < static_cast<ptrdiff_t>(length)) return false;
+            s.assign(pos, length);
+            pos += length;
+            return true;
+        }
+        bool getPoint(Point& p) {
+            string name;
+            double x, y;
+            if (!getString(name) || !get(x) || !get(y)) return false;
+            p = Point(name, x, y);
+            return true;
+        }
+    };
+}
+
+bool TiledEnvironment::writeTiles(const Environment& env, const string& path, double tileSize) {
+    if (tileSize <= 0) return false;
+    auto tileOf = [tileSize](double x, double y) {
+        return make_pair(static_cast<int32_t>(floor(x / tileSize)), static_cast<int32_t>(floor(y / tileSize)));
+    };
+    map<pair<int32_t, int32_t>, pair<vector<const Route*>, vector<const Obstacle*>>> tiles;
+    for (auto const& r : env.getRoutes()) {
+        auto a = tileOf(r.getStart().getX(), r.getStart().getY());
+        auto b = tileOf(r.getDestination().getX(), r.getDestination().getY());
+        tiles[a].first.push_back(&r);
+        if (b != a) tiles[b].first.push_back(&r);
+    }
+    for (auto const& o : env.getObstacles()) tiles[tileOf(o.getX(), o.getY())].second.push_back(&o);
+
+    BlobWriter header, blocks;
+    header.data.append(Magic, sizeof(Magic));
+    header.put<uint32_t>(Version);
+    header.put<double>(tileSize);
+    header.put<uint32_t>(static_cast<uint32_t>(tiles.size()));
+    uint64_t base = header.data.size() + tiles.size() * EntrySize;
+
+    for (auto const& [tile, content] : tiles) {
+        uint64_t offset = base + blocks.data.size();
+        blocks.put<uint32_t>(static_cast<uint32_t>(content.first.size()));
+        blocks.put<uint32_t>(static_cast<uint32_t>(content.second.size()));
+        for (const Route* r : content.first) {
+            blocks.putPoint(r->getStart());
+            blocks.putPoint(r->getDestination());
+            blocks.put<double>(r->getDistance());
+        }
+        for (const Obstacle* o : content.second) {
+            blocks.putString(o->getDescription());
+            blocks.put<double>(o->getX());
+            blocks.put<double>(o->getY());
+        }
+        header.put<int32_t>(tile.first);
+        header.put<int32_t>(tile.second);
+        header.put<uint64_t>(offset);
+        header.put<uint64_t>(base + blocks.data.size() - offset);
+    }
+
+    ofstream out(path, ios::binary | ios::trunc);
+    if (!out) return false;
+    out.write(header.data.data(), header.data.size());
+    out.write(blocks.data.data(), blocks.data.size());
+    return static_cast<bool>(out);
+}
+
+TiledEnvironment::TiledEnvironment(size_t memoryBudget) : memoryBudget(memoryBudget) {}
+
+TiledEnvironment::~TiledEnvironment() {
+    close();
+}
+
+bool TiledEnvironment::open(const string& filePath) {
+    close();
+    ifstream in(filePath, ios::binary);
+    if (!in) return false;
+    char magic[4];
+    uint32_t version = 0, count = 0;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&tileSize), sizeof(tileSize));
+    in.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!in || memcmp(magic, Magic, sizeof(Magic)) != 0 || version != Version || !(tileSize > 0)) return false;
+
+    // The index must fit in the file, so a corrupt count cannot cause a huge allocation.
+    uint64_t headerEnd = static_cast<uint64_t>(in.tellg());
+    in.seekg(0, ios::end);
+    uint64_t fileSize = static_cast<uint64_t>(in.tellg());
+    in.seekg(static_cast<streamoff>(headerEnd));
+    if (!in || fileSize < headerEnd || count > (fileSize - headerEnd) / EntrySize) return false;
+
+    vector<char> entries(static_cast<size_t>(count) * EntrySize);
+    in.read(entries.data(), entries.size());
+    if (!in) return false;
+    BlobReader reader = { entries.data(), entries.data() + entries.size() };
+    for (uint32_t i = 0; i < count; i++) {
+        int32_t tx = 0, ty = 0;
+        IndexEntry entry = { 0, 0 };
+        reader.get(tx);
+        reader.get(ty);
+        reader.get(entry.offset);
+        reader.get(entry.size);
+        if (entry.offset > fileSize || entry.size > fileSize - entry.offset) {
+            index.clear();
+            return false;
+        }
+        index[packTile(tx, ty)] = entry;
+    }
+
+    path = filePath;
+#ifdef __linux__
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        index.clear();
+        return false;
+    }
+#endif
+    return true;
+}
+
+void TiledEnvironment::close() {
+    resident.clear();
+    residentByKey.clear();
+    index.clear();
+    bytesInUse = 0;
+#ifdef __linux__
+    if (fd >= 0) ::close(fd);
+#endif
+    fd = -1;
+}
+
+long long TiledEnvironment::tileKey(double x, double y) const {
+    return packTile(static_cast<long long>(floor(x / tileSize)), static_cast<long long>(floor(y / tileSize)));
+}
+
+TiledEnvironment::MappedBlock::MappedBlock(const TiledEnvironment& owner, const IndexEntry& entry) {
+#ifdef __linux__
+    // mmap offsets must be page aligned.
+    static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t start = entry.offset / pageSize * pageSize;
+    length = static_cast<size_t>(entry.offset - start + entry.size);
+    mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, owner.fd, static_cast<off_t>(start));
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        return;
+    }
+    data = static_cast<const char*>(mapping) + (entry.offset - start);
+    size = static_cast<size_t>(entry.size);
+#else
+    ifstream in(owner.path, ios::binary);
+    in.seekg(static_cast<streamoff>(entry.offset));
+    copy.resize(static_cast<size_t>(entry.size));
+    in.read(copy.data(), copy.size());
+    if (!in) return;
+    data = copy.data();
+    size = copy.size();
+#endif
+}
+
+TiledEnvironment::MappedBlock::~MappedBlock() {
+#ifdef __linux__
+    if (mapping) munmap(mapping, length);
+#endif
+}
+
+TiledEnvironment::Tile* TiledEnvironment::load(long long key) {
+    auto hit = residentByKey.find(key);
+    if (hit != residentByKey.end()) {
+        resident.splice(resident.begin(), resident, hit->second);
+        return resident.front().get();
+    }
+    auto entry = index.find(key);
+    if (entry == index.end()) return nullptr;
+
+    TRACE_SCOPE("environment", "load_tile");
+    MappedBlock block(*this, entry->second);
+    if (!block.data) return nullptr;
+    auto tile = make_unique<Tile>();
+    tile->key = key;
+    BlobReader reader = { block.data, block.data + block.size };
+    uint32_t routeCount = 0, obstacleCount = 0;
+    reader.get(routeCount);
+    reader.get(obstacleCount);
+    Point start("", 0, 0), destination("", 0, 0);
+    for (uint32_t i = 0; i < routeCount; i++) {
+        double distance;
+        if (!reader.getPoint(start) || !reader.getPoint(destination) || !reader.get(distance)) return nullptr;
+        tile->env.addRoute(Route(start, destination, distance));
+        tile->bytes += sizeof(Route) + 4 * sizeof(int) + start.getName().size() + destination.getName().size();
+    }
+    for (uint32_t i = 0; i < obstacleCount; i++) {
+        string description;
+        double x, y;
+        if (!reader.getString(description) || !reader.get(x) || !reader.get(y)) return nullptr;
+        tile->env.addObstacle(Obstacle(description, x, y));
+        tile->bytes += sizeof(Obstacle) + description.size();
+    }
+    tile->bytes += tile->env.pointCount() * (sizeof(string) + sizeof(vector<int>) + 2 * sizeof(void*));
+
+    bytesInUse += tile->bytes;
+    loads++;
+    resident.push_front(move(tile));
+    residentByKey[key] = resident.begin();
+    evict();
+    return resident.front().get();
+}
+
+void TiledEnvironment::evict() {
+    while (bytesInUse > memoryBudget && resident.size() > 1) {
+        bytesInUse -= resident.back()->bytes;
+        residentByKey.erase(resident.back()->key);
+        resident.pop_back();
+    }
+}
+
+const Environment* TiledEnvironment::tileAt(double x, double y) {
+    Tile* tile = load(tileKey(x, y));
+    return tile ? &tile->env : nullptr;
+}
+
+vector<Obstacle> TiledEnvironment::obstaclesIn(double minX, double minY, double maxX, double maxY) {
+    vector<Obstacle> found;
+    long long tx0 = static_cast<long long>(floor(minX / tileSize)), tx1 = static_cast<long long>(floor(maxX / tileSize));
+    long long ty0 = static_cast<long long>(floor(minY / tileSize)), ty1 = static_cast<long long>(floor(maxY / tileSize));
+    for (long long tx = tx0; tx <= tx1; tx++) {
+        for (long long ty = ty0; ty <= ty1; ty++) {
+            long long key = packTile(tx, ty);
+            if (index.find(key) == index.end()) continue;
+            Tile* tile = load(key);
+            if (!tile) continue;
+            for (auto const& o : tile->env.getObstacles())
+                if (o.getX() >= minX && o.getX() <= maxX && o.getY() >= minY && o.getY() <= maxY) found.push_back(o);
+        }
+    }
+    return found;
+}
+
+pair<vector<Point>, double> TiledEnvironment::findRoute(const Point& start, const Point& end) {
+    TRACE_SCOPE("environment", "tiled_findRoute");
+    using Entry = pair<double, string>;
+    priority_queue<Entry, vector<Entry>, greater<Entry>> pq;
+    unordered_map<string, double> dist;
+    unordered_map<string, Point> points;
+    unordered_map<string, string> previous;
+    vector<pair<Point, double>> neighbors;
+
+    dist[start.getName()] = 0;
+    points.emplace(start.getName(), start);
+    pq.push({ 0, start.getName() });
+    while (!pq.empty()) {
+        auto [d, name] = pq.top();
+        pq.pop();
+        if (d > dist[name]) continue;
+        if (name == end.getName()) break;
+
+        // Copy the neighbors out: loading the next tile may evict this one.
+        const Point& here = points.at(name);
+        neighbors.clear();
+        if (Tile* tile = load(tileKey(here.getX(), here.getY()))) {
+            auto const& routes = tile->env.getRoutes();
+            for (int r : tile->env.routesAt(name)) {
+                const Route& route = routes[r];
+                if (route.getStart().getName() == name) neighbors.push_back({ route.getDestination(), route.getDistance() });
+            }
+        }
+        for (auto const& [other, w] : neighbors) {
+            auto known = dist.find(other.getName());
+            if (known != dist.end() && known->second <= d + w) continue;
+            dist[other.getName()] = d + w;
+            points.insert_or_assign(other.getName(), other);
+            previous[other.getName()] = name;
+            pq.push({ d + w, other.getName() });
+        }
+    }
+
+    auto reached = dist.find(end.getName());
+    if (reached == dist.end()) return { {}, -1 };
+    vector<Point> path;
+    for (string at = end.getName();; at = previous[at]) {
+        path.push_back(points.at(at));
+        if (at == start.getName()) break;
+    }
+    reverse(path.begin(), path.end());
+    return { path, reached->second };
+}
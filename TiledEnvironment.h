@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Environment.h"
+using namespace std;
+
+// An Environment split into square spatial tiles that are loaded on demand.
+//
+// writeTiles() stores routes and obstacles in one file: a small index followed
+// by one binary block per tile. A route is stored in the tile of each of its
+// endpoints, so all routes of a point are found in the point's tile. open() reads
+// only the index; a tile is mapped (mmap) and decoded the first time a query
+// touches it, and the least recently used tiles are dropped when the decoded
+// size exceeds the memory budget. The tile needed by the current query is
+// always kept, even if it alone is over budget.
+class TiledEnvironment {
+public:
+    static bool writeTiles(const Environment& env, const string& path, double tileSize);
+
+    explicit TiledEnvironment(size_t memoryBudget);
+    ~TiledEnvironment();
+    TiledEnvironment(const TiledEnvironment&) = delete;
+    TiledEnvironment& operator=(const TiledEnvironment&) = delete;
+
+    // Reads the tile index; false if the file is missing, not a tile file, or its
+    // index does not fit in the file.
+    bool open(const string& path);
+    void close();
+
+    double getTileSize() const { return tileSize; }
+    size_t tileCount() const { return index.size(); }
+    size_t residentTiles() const { return resident.size(); }
+    size_t residentBytes() const { return bytesInUse; }
+    size_t tileLoads() const { return loads; }
+
+    // Tile containing (x, y), loaded if needed; nullptr if the file has no data there.
+    // Valid until the next call that loads a tile.
+    const Environment* tileAt(double x, double y);
+
+    // Obstacles inside the rectangle, loading the tiles it overlaps.
+    vector<Obstacle> obstaclesIn(double minX, double minY, double maxX, double maxY);
+
+    // Shortest route between two points (matched by name; routes are directed,
+    // as in Environment: a route A->B is not followed from B to A),
+    // with Dijkstra pulling in the tiles of the points it reaches. Returns the points
+    // along the way and the total distance, or an empty path and -1.
+    pair<vector<Point>, double> findRoute(const Point& start, const Point& end);
+
+private:
+    struct IndexEntry {
+        uint64_t offset;
+        uint64_t size;
+    };
+    struct Tile {
+        long long key;
+        Environment env;
+        size_t bytes = 0;
+    };
+
+    // One tile block of the file, mapped for decoding (read into memory where mmap is unavailable).
+    struct MappedBlock {
+        MappedBlock(const TiledEnvironment& owner, const IndexEntry& entry);
+        ~MappedBlock();
+        MappedBlock(const MappedBlock&) = delete;
+        MappedBlock& operator=(const MappedBlock&) = delete;
+        const char* data = nullptr;
+        size_t size = 0;
+    private:
+        void* mapping = nullptr;
+        size_t length = 0;
+        vector<char> copy;
+    };
+
+    long long tileKey(double x, double y) const;
+    Tile* load(long long key);
+    void evict();
+
+    size_t memoryBudget;
+    double tileSize = 1;
+    string path;
+    int fd = -1;
+    unordered_map<long long, IndexEntry> index;
+    // Most recently used first.
+    list<unique_ptr<Tile>> resident;
+    unordered_map<long long, list<unique_ptr<Tile>>::iterator> residentByKey;
+    size_t bytesInUse = 0;
+    size_t loads = 0;
+};
@@ -0,0 +1,147 @@
+#include "Trace.h"
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+using namespace std;
+
+namespace {
+    enum class BufferState { Live, Exited, Free };
+
+    // Buffers are owned by the registry so events survive thread exit. An exited
+    // thread's buffer becomes free once its events were exported or cleared.
+    struct RegistryEntry {
+        unique_ptr<TraceBuffer> buffer;
+        BufferState state;
+        uint64_t exitOrder; // orders exited buffers, oldest first
+    };
+    mutex registryMutex;
+    vector<RegistryEntry> registry;
+    uint32_t nextThreadId = 1;
+    uint64_t exitCount = 0;
+
+    // Callers hold registryMutex.
+    TraceBuffer* acquireBuffer() {
+        RegistryEntry* reuse = nullptr;
+        size_t exited = 0;
+        for (auto& entry : registry) {
+            if (entry.state == BufferState::Free) {
+                reuse = &entry;
+                break;
+            }
+            if (entry.state == BufferState::Exited) {
+                exited++;
+                if (!reuse || entry.exitOrder < reuse->exitOrder) reuse = &entry;
+            }
+        }
+        if (reuse && (reuse->state == BufferState::Free || exited >= Tracer::MaxExitedBuffers)) {
+            reuse->state = BufferState::Live;
+            reuse->buffer->reassign(nextThreadId++);
+            return reuse->buffer.get();
+        }
+        registry.push_back({ make_unique<TraceBuffer>(nextThreadId++), BufferState::Live, 0 });
+        return registry.back().buffer.get();
+    }
+
+    struct ThreadBuffer {
+        TraceBuffer* buffer = nullptr;
+        ~ThreadBuffer() {
+            if (!buffer) return;
+            lock_guard<mutex> lock(registryMutex);
+            for (auto& entry : registry) {
+                if (entry.buffer.get() != buffer) continue;
+                entry.state = BufferState::Exited;
+                entry.exitOrder = exitCount++;
+            }
+        }
+    };
+
+    void appendEscaped(ostringstream& out, const char* s) {
+        for (; *s; ++s) {
+            unsigned char c = static_cast<unsigned char>(*s);
+            if (c < 0x20) {
+                // Control characters are not allowed raw in JSON strings.
+                char escaped[8];
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out << escaped;
+                continue;
+            }
+            if (*s == '"' || *s == '\\') out << '\\';
+            out << *s;
+        }
+    }
+}
+
+TraceBuffer& Tracer::threadBuffer() {
+    thread_local ThreadBuffer local;
+    if (!local.buffer) {
+        lock_guard<mutex> lock(registryMutex);
+        local.buffer = acquireBuffer();
+    }
+    return *local.buffer;
+}
+
+string Tracer::toChromeJson() {
+    vector<TraceBuffer*> buffers;
+    vector<pair<TraceBuffer*, uint64_t>> exited; // collected below, then free
+    {
+        lock_guard<mutex> lock(registryMutex);
+        for (auto const& entry : registry) {
+            buffers.push_back(entry.buffer.get());
+            if (entry.state == BufferState::Exited) exited.emplace_back(entry.buffer.get(), entry.exitOrder);
+        }
+    }
+
+    ostringstream out;
+    out.setf(ios::fixed);
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (auto const& buffer : buffers) {
+        uint64_t written = buffer->getWritten();
+        uint64_t begin = written > TraceBuffer::Capacity ? written - TraceBuffer::Capacity : 0;
+        for (uint64_t i = begin; i < written; i++) {
+            const TraceEvent& e = buffer->at(i);
+            if (!first) out << ",";
+            first = false;
+            out << "\n{\"name\":\"";
+            appendEscaped(out, e.name);
+            out << "\",\"cat\":\"";
+            appendEscaped(out, e.category);
+            // Chrome trace timestamps are microseconds.
+            out << "\",\"ph\":\"X\",\"ts\":" << e.startNs / 1000.0 << ",\"dur\":" << e.durationNs / 1000.0
+                << ",\"pid\":1,\"tid\":" << buffer->getThreadId() << "}";
+        }
+    }
+    out << "\n]}\n";
+
+    // Buffers of threads that exited before the export are done with, unless
+    // they were reused in the meantime.
+    lock_guard<mutex> lock(registryMutex);
+    for (auto& entry : registry)
+        for (auto const& [buffer, order] : exited)
+            if (entry.buffer.get() == buffer && entry.state == BufferState::Exited && entry.exitOrder == order)
+                entry.state = BufferState::Free;
+    return out.str();
+}
+
+bool Tracer::writeChromeJson(const string& path) {
+    ofstream file(path);
+    if (!file) return false;
+    file << toChromeJson();
+    return static_cast<bool>(file);
+}
+
+void Tracer::clear() {
+    lock_guard<mutex> lock(registryMutex);
+    for (auto& entry : registry) {
+        entry.buffer->reset();
+        if (entry.state == BufferState::Exited) entry.state = BufferState::Free;
+    }
+}
+
+size_t Tracer::bufferCount() {
+    lock_guard<mutex> lock(registryMutex);
+    return registry.size();
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+using namespace std;
+
+// Lightweight scoped trace spans exported as Chrome trace-event JSON
+// (open the file in Perfetto or chrome://tracing).
+//
+// Every thread records into its own ring buffer, so recording a span takes no
+// locks; the only lock is taken once per thread when its buffer is registered.
+// When a thread exits, its buffer is kept until its events have been exported
+// (or cleared) and then handed to the next new thread. At most
+// Tracer::MaxExitedBuffers buffers of exited threads are kept waiting; beyond
+// that the oldest one is reused and its events are lost.
+// Spans are placed with TRACE_SCOPE, which compiles to nothing unless
+// ENABLE_TRACING is defined.
+
+struct TraceEvent {
+    const char* category; // string literals only, the pointer is stored
+    const char* name;
+    uint64_t startNs;
+    uint64_t durationNs;
+};
+
+// Ring buffer owned by one thread. When full, the oldest events are overwritten.
+class TraceBuffer {
+public:
+    static constexpr size_t Capacity = 1 << 16;
+
+    explicit TraceBuffer(uint32_t tid) : threadId(tid), events(Capacity) {}
+
+    void push(const TraceEvent& e) {
+        uint64_t i = written.load(memory_order_relaxed);
+        events[i & (Capacity - 1)] = e;
+        written.store(i + 1, memory_order_release);
+    }
+
+    uint32_t getThreadId() const { return threadId; }
+    uint64_t getWritten() const { return written.load(memory_order_acquire); }
+    const TraceEvent& at(uint64_t i) const { return events[i & (Capacity - 1)]; }
+    void reset() { written.store(0, memory_order_release); }
+    // Hands the buffer to another thread; its events are dropped.
+    void reassign(uint32_t tid) {
+        threadId = tid;
+        reset();
+    }
+
+private:
+    uint32_t threadId;
+    vector<TraceEvent> events;
+    atomic<uint64_t> written{ 0 };
+};
+
+class Tracer {
+public:
+    static constexpr size_t MaxExitedBuffers = 64;
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Buffer of the calling thread (registered on first use).
+    static TraceBuffer& threadBuffer();
+
+    // Writes all buffered events. Call it while the traced threads are idle,
+    // events being written concurrently may come out torn.
+    static bool writeChromeJson(const string& path);
+    static string toChromeJson();
+
+    // Drops all recorded events. Like writeChromeJson, only while the traced
+    // threads are idle: a thread pushing concurrently may keep a stale count.
+    static void clear();
+
+    // Ring buffers allocated so far (live and exited threads).
+    static size_t bufferCount();
+};
+
+class TraceSpan {
+    const char* category;
+    const char* name;
+    uint64_t start;
+public:
+    TraceSpan(const char* cat, const char* spanName) : category(cat), name(spanName), start(Tracer::nowNs()) {}
+    ~TraceSpan() {
+        uint64_t end = Tracer::nowNs();
+        Tracer::threadBuffer().push({ category, name, start, end - start });
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#ifdef ENABLE_TRACING
+#define TRACE_SCOPE(category, name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(category, name)
+#else
+#define TRACE_SCOPE(category, name) ((void)0)
+#endif
@@ -106,8 +106,8 @@ void AirTransport::info() const {
 }
 
 // Car
-Car::Car(string n, double s, int w, string fuel, double fuelCap, double consumptionRate)
-    : LandTransport(n, s, w, fuelCap), fuelType(fuel), fuelConsumptionRate(consumptionRate) {
+Car::Car(string n, double s, int w, string fuel, double fuelCap, double consumptionRate, int seatCount)
+    : LandTransport(n, s, w, fuelCap), fuelType(fuel), fuelConsumptionRate(consumptionRate), seats(seatCount) {
 }
 
 void Car::move(double distance) {
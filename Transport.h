@@ -26,6 +26,8 @@ public:
     double getSpeed() const { return speed; }
     virtual void setFuel(double) {}
     virtual double getFuel() const { return 0.0; }
+    // Passenger places available for shared rides; 0 = does not carry passengers.
+    virtual int getCapacity() const { return 0; }
 };
 
 // Land transport
@@ -84,14 +86,17 @@ public:
 class Car : public LandTransport {
     string fuelType;
     double fuelConsumptionRate; // liters per km
+    int seats; // passenger seats (driver excluded)
 public:
-    Car(string n, double s, int w, string fuel, double fuelCap, double consumptionRate);
+    Car(string n, double s, int w, string fuel, double fuelCap, double consumptionRate, int seatCount = 4);
     void move(double distance) override;
     void info() const override;
     double getFuelLevel() const;
     double getSpeed() const;
 	string getFuelType() const { return fuelType; }
 	double getFuelConsumptionRate() const { return fuelConsumptionRate; }
+    int getSeats() const { return seats; }
+    int getCapacity() const override { return seats; }
     void setFuel(double amount) { currentFuel = std::max(0.0, std::min(amount, fuelCapacity)); }
 };
 
@@ -137,6 +142,7 @@ public:
     double getFuelLevel() const;
     double getSpeed() const;
 	int getPassengers() const { return passengers; }
+    int getCapacity() const override { return passengers; }
     double getFuelConsumptionRate() const { return fuelConsumptionRate; }
     void setFuel(double amount) { currentFuel = std::max(0.0, std::min(amount, fuelCapacity)); }
 };
@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "../Graph.h"
+using namespace std;
+
+// Shared helpers for the benchmark programs: deterministic inputs, timing and statistics.
+
+// Deterministic random numbers.
+// mt19937_64 output is fixed by the standard, the std distributions are not,
+// so ranges are derived by hand to get identical graphs on every platform.
+class BenchRng {
+    mt19937_64 engine;
+public:
+    explicit BenchRng(uint64_t seed) : engine(seed) {}
+    uint64_t next() { return engine(); }
+    int nextInt(int lo, int hi) { return lo + static_cast<int>(engine() % static_cast<uint64_t>(hi - lo + 1)); }
+    double nextDouble() { return (engine() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// Random connected graph: a random spanning path plus extra random edges.
+inline Graph<int> make_random_graph(int vertices, int edgesPerVertex, int maxWeight, uint64_t seed, bool directed = false) {
+    Graph<int> g(directed);
+    BenchRng rng(seed);
+    vector<int> order(vertices);
+    for (int i = 0; i < vertices; i++) order[i] = i;
+    for (int i = vertices - 1; i > 0; i--)
+        swap(order[i], order[rng.nextInt(0, i)]);
+
+    for (int i = 0; i < vertices; i++)
+        g.add_vertex(i);
+    for (int i = 1; i < vertices; i++)
+        g.add_edge(order[i - 1], order[i], rng.nextInt(1, maxWeight));
+
+    long long extra = static_cast<long long>(vertices) * max(0, edgesPerVertex - 1);
+    for (long long i = 0; i < extra; i++) {
+        int u = rng.nextInt(0, vertices - 1);
+        int v = rng.nextInt(0, vertices - 1);
+        if (u != v) g.add_edge(u, v, rng.nextInt(1, maxWeight));
+    }
+    return g;
+}
+
+// rows x cols road-like grid, vertex id = r * cols + c.
+inline Graph<int> make_grid_graph(int rows, int cols, int maxWeight, uint64_t seed) {
+    Graph<int> g(false);
+    BenchRng rng(seed);
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < cols; c++) {
+            int v = r * cols + c;
+            g.add_vertex(v);
+            if (c + 1 < cols) g.add_edge(v, v + 1, rng.nextInt(1, maxWeight));
+            if (r + 1 < rows) g.add_edge(v, v + cols, rng.nextInt(1, maxWeight));
+        }
+    }
+    return g;
+}
+
+// Redirects cout into nothing while alive (Transport and Environment print on every call).
+class CoutSilencer {
+    struct NullBuffer : streambuf {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+        streamsize xsputn(const char*, streamsize n) override { return n; }
+    } nullBuffer;
+    streambuf* old;
+public:
+    CoutSilencer() : old(cout.rdbuf(&nullBuffer)) {}
+    ~CoutSilencer() { cout.rdbuf(old); }
+    CoutSilencer(const CoutSilencer&) = delete;
+    CoutSilencer& operator=(const CoutSilencer&) = delete;
+};
+
+// Keeps results observable so the optimizer cannot drop the measured work.
+inline volatile long long benchSink = 0;
+template<typename T>
+inline void bench_consume(const T& value) { benchSink = benchSink + static_cast<long long>(value); }
+
+inline double now_ns() {
+    return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// Runs fn() `warmup` times, then returns `samples` timings in nanoseconds per call,
+// each sample averaging `innerIterations` calls.
+template<typename F>
+vector<double> measure_ns(F&& fn, int samples, int innerIterations = 1, int warmup = 2) {
+    for (int i = 0; i < warmup; i++) fn();
+    vector<double> result;
+    result.reserve(samples);
+    for (int s = 0; s < samples; s++) {
+        double t0 = now_ns();
+        for (int i = 0; i < innerIterations; i++) fn();
+        result.push_back((now_ns() - t0) / innerIterations);
+    }
+    return result;
+}
+
+// Two-sided 95% Student t critical values, index = degrees of freedom.
+inline double t_critical_95(double df) {
+    static const double table[] = { 0, 12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042 };
+    if (df < 1) return table[1];
+    if (df <= 30) return table[static_cast<int>(df)];
+    return 1.96 + 2.4 / df; // close enough above 30
+}
+
+struct SampleStats {
+    int n = 0;
+    double mean = 0, stddev = 0, median = 0, min = 0;
+    double ciLow = 0, ciHigh = 0; // 95% confidence interval of the mean
+};
+
+inline double median_of(vector<double> v) {
+    if (v.empty()) return 0;
+    sort(v.begin(), v.end());
+    size_t m = v.size() / 2;
+    return v.size() % 2 ? v[m] : (v[m - 1] + v[m]) / 2;
+}
+
+// Noise filter: drops samples further than 3 scaled MADs from the median
+// (interrupts, page faults, frequency changes show up as one-sided outliers).
+inline vector<double> filter_outliers(const vector<double>& samples) {
+    if (samples.size() < 5) return samples;
+    double med = median_of(samples);
+    vector<double> dev;
+    for (double s : samples) dev.push_back(fabs(s - med));
+    double mad = 1.4826 * median_of(dev);
+    if (mad == 0) return samples;
+    vector<double> kept;
+    for (double s : samples)
+        if (fabs(s - med) <= 3 * mad) kept.push_back(s);
+    return kept;
+}
+
+inline SampleStats compute_stats(const vector<double>& samples) {
+    SampleStats st;
+    st.n = static_cast<int>(samples.size());
+    if (st.n == 0) return st;
+    for (double s : samples) st.mean += s;
+    st.mean /= st.n;
+    for (double s : samples) st.stddev += (s - st.mean) * (s - st.mean);
+    st.stddev = st.n > 1 ? sqrt(st.stddev / (st.n - 1)) : 0;
+    st.median = median_of(samples);
+    st.min = *min_element(samples.begin(), samples.end());
+    double half = st.n > 1 ? t_critical_95(st.n - 1) * st.stddev / sqrt(static_cast<double>(st.n)) : 0;
+    st.ciLow = st.mean - half;
+    st.ciHigh = st.mean + half;
+    return st;
+}
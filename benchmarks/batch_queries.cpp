@@ -0,0 +1,52 @@
+// Throughput of interleaved point-to-point searches on one core.
+//
+//   batch_queries [vertices] [queries]
+//
+// Compares FrozenGraph::shortest_path called per query with
+// FrozenGraph::shortest_paths_batch at several interleave widths
+// (width 1 is the same state machine without overlap).
+
+#include "BenchCommon.h"
+#include "../FrozenGraph.h"
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? atoi(argv[1]) : 1000000;
+    int queryCount = argc > 2 ? atoi(argv[2]) : 64;
+
+    cout << "Building graph with " << vertices << " vertices...\n";
+    FrozenGraph<int> fg(make_random_graph(vertices, 4, 100, 606));
+
+    BenchRng rng(11);
+    vector<pair<int, int>> queries(queryCount);
+    for (auto& q : queries) q = { rng.nextInt(0, vertices - 1), rng.nextInt(0, vertices - 1) };
+
+    double t0 = now_ns();
+    long long checksum = 0;
+    for (auto const& [s, t] : queries)
+        checksum += fg.shortest_path(s, t, false).second;
+    double single = queryCount / ((now_ns() - t0) / 1e9);
+    bench_consume(checksum);
+
+    cout << left << setw(24) << "mode" << right << setw(14) << "queries/s" << setw(12) << "speedup" << "\n";
+    cout << fixed << setprecision(1);
+    cout << left << setw(24) << "shortest_path" << right << setw(14) << single << setw(11) << 1.0 << "x\n";
+
+    for (int width : { 1, 2, 4, 8, 16, 32 }) {
+        t0 = now_ns();
+        auto results = fg.shortest_paths_batch(queries, width);
+        double qs = queryCount / ((now_ns() - t0) / 1e9);
+
+        long long batchChecksum = 0;
+        for (auto const& r : results) batchChecksum += r.second;
+        if (batchChecksum != checksum) {
+            cerr << "Result mismatch at width " << width << "\n";
+            return 1;
+        }
+        cout << left << setw(24) << ("batch, interleave " + to_string(width)) << right << setw(14) << qs
+             << setw(11) << qs / single << "x\n";
+    }
+    return 0;
+}
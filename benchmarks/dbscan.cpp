@@ -0,0 +1,49 @@
+// DBSCAN time for large point sets.
+//
+//   dbscan [points] [threads]
+//
+// Half of the points are spread over 1000 Gaussian-like incident clusters, the
+// rest is uniform noise over a 1000 x 1000 km area.
+
+#include "BenchCommon.h"
+#include "../Dbscan.h"
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int count = argc > 1 ? atoi(argv[1]) : 1000000;
+    int threads = argc > 2 ? atoi(argv[2]) : static_cast<int>(thread::hardware_concurrency());
+
+    BenchRng rng(23);
+    vector<double> xs, ys;
+    xs.reserve(count);
+    ys.reserve(count);
+    vector<pair<double, double>> centers(1000);
+    for (auto& c : centers) c = { rng.nextDouble() * 1000, rng.nextDouble() * 1000 };
+    for (int i = 0; i < count; i++) {
+        if (i % 2 == 0) {
+            auto const& c = centers[rng.nextInt(0, static_cast<int>(centers.size()) - 1)];
+            // Sum of uniforms: a cheap bell shape with a spread of about 1 km.
+            double dx = rng.nextDouble() + rng.nextDouble() + rng.nextDouble() - 1.5;
+            double dy = rng.nextDouble() + rng.nextDouble() + rng.nextDouble() - 1.5;
+            xs.push_back(c.first + dx);
+            ys.push_back(c.second + dy);
+        }
+        else {
+            xs.push_back(rng.nextDouble() * 1000);
+            ys.push_back(rng.nextDouble() * 1000);
+        }
+    }
+
+    double t0 = now_ns();
+    DbscanResult result = dbscan(xs, ys, 0.1, 8, threads);
+    double ms = (now_ns() - t0) / 1e6;
+
+    size_t noise = 0;
+    for (int label : result.labels) noise += label < 0;
+    cout << fixed << setprecision(1);
+    cout << count << " points, " << threads << " threads: " << ms << " ms, "
+         << result.clusterCount << " clusters, " << noise << " noise points\n";
+    return 0;
+}
@@ -0,0 +1,71 @@
+// Cost of shipping a topology update as a delta patch versus a full reload.
+//
+//   graph_delta [side] [edits]
+//
+// A side x side road-like grid gets `edits` random edits: weight changes (90%),
+// closed roads (5%) and new junctions connected to two existing ones (5%). The
+// primary diffs the two versions and encodes the patch; a replica decodes it and
+// patches its FrozenGraph. The full reload is the snapshot rebuilt from the
+// updated Graph. Weight-only updates keep the vertex numbering and are shown
+// separately.
+
+#include "BenchCommon.h"
+#include "../FrozenGraph.h"
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int side = argc > 1 ? atoi(argv[1]) : 700;
+    int edits = argc > 2 ? atoi(argv[2]) : 10000;
+    int n = side * side;
+
+    Graph<int> base = make_grid_graph(side, side, 10, 71);
+    FrozenGraph<int> replica(base);
+    BenchRng rng(72);
+    Graph<int> reweighted = base, updated = base;
+    int junction = n;
+    for (int i = 0; i < edits; i++) {
+        int u = rng.nextInt(0, n - 2);
+        int v = u % side + 1 < side ? u + 1 : u + side < n ? u + side : u - 1;
+        int kind = rng.nextInt(0, 99);
+        if (kind < 90) {
+            int w = rng.nextInt(1, 20);
+            reweighted.set_edge_weight(u, v, w);
+            updated.set_edge_weight(u, v, w);
+        } else if (kind < 95) {
+            updated.remove_edge(u, v);
+        } else {
+            updated.add_edge(junction, u, rng.nextInt(1, 10));
+            updated.add_edge(junction, v, rng.nextInt(1, 10));
+            junction++;
+        }
+    }
+
+    cout << n << " vertices, " << replica.edge_count() << " arcs, " << edits << " edits\n\n";
+    cout << left << setw(16) << "update" << right << setw(12) << "patch KB" << setw(12) << "diff ms"
+         << setw(12) << "decode ms" << setw(12) << "patch ms" << setw(12) << "reload ms" << "\n";
+    auto run = [&](const string& name, const Graph<int>& next) {
+        double t0 = now_ns();
+        GraphDelta<int> delta = diff_graphs(base, next);
+        string patch = encode_graph_delta(delta);
+        double diffNs = now_ns() - t0;
+
+        GraphDelta<int> received;
+        t0 = now_ns();
+        bool ok = decode_graph_delta(patch, received);
+        double decodeNs = now_ns() - t0;
+        FrozenGraph<int> patched;
+        auto patchNs = median_of(measure_ns([&] { ok = replica.patch(received, patched) && ok; }, 5, 1, 1));
+        auto reloadNs = median_of(measure_ns([&] { bench_consume(FrozenGraph<int>(next).edge_count()); }, 3, 1, 1));
+        if (!ok || patched.edge_count() != FrozenGraph<int>(next).edge_count()) {
+            cerr << name << ": patched snapshot does not match the reload\n";
+            return false;
+        }
+        cout << left << setw(16) << name << right << fixed << setprecision(1) << setw(12) << patch.size() / 1e3
+             << setw(12) << diffNs / 1e6 << setw(12) << decodeNs / 1e6 << setw(12) << patchNs / 1e6
+             << setw(12) << reloadNs / 1e6 << "\n";
+        return true;
+    };
+    return run("weights only", reweighted) && run("mixed", updated) ? 0 : 1;
+}
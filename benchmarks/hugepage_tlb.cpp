@@ -0,0 +1,100 @@
+// dTLB misses and time of FrozenGraph::shortest_path with regular pages,
+// transparent huge pages and hugetlbfs pages.
+//
+//   hugepage_tlb [vertices] [queries]
+//
+// dTLB misses are read with perf_event_open (Linux); "n/a" means the counter is
+// not available (e.g. kernel.perf_event_paranoid too high, or a VM without PMU).
+// HugeTLB needs reserved pages (vm.nr_hugepages), otherwise it falls back to THP.
+
+#include "BenchCommon.h"
+#include "../FrozenGraph.h"
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+class DtlbCounter {
+    int fd = -1;
+public:
+    DtlbCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+#endif
+    }
+    ~DtlbCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+    bool available() const { return fd >= 0; }
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    long long stop() {
+        long long value = -1;
+#ifdef __linux__
+        if (fd < 0) return -1;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &value, sizeof(value)) != sizeof(value)) value = -1;
+#endif
+        return value;
+    }
+};
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? atoi(argv[1]) : 2000000;
+    int queryCount = argc > 2 ? atoi(argv[2]) : 20;
+
+    cout << "Transparent huge pages " << (transparent_huge_pages_available() ? "available" : "disabled") << "\n";
+    cout << "Building graph with " << vertices << " vertices...\n";
+    Graph<int> g = make_random_graph(vertices, 4, 100, 5150);
+
+    BenchRng rng(3);
+    vector<pair<int, int>> queries(queryCount);
+    for (auto& q : queries) q = { rng.nextInt(0, vertices - 1), rng.nextInt(0, vertices - 1) };
+
+    struct Mode { const char* name; PageBacking backing; };
+    const Mode modes[] = {
+        { "default", PageBacking::Default },
+        { "transparent_huge", PageBacking::TransparentHuge },
+        { "hugetlb", PageBacking::HugeTLB },
+    };
+
+    DtlbCounter counter;
+    cout << left << setw(20) << "backing" << right << setw(14) << "ms/query" << setw(20) << "dTLB misses/query" << "\n";
+    for (auto const& mode : modes) {
+        FrozenGraph<int> fg(g, mode.backing);
+        fg.shortest_path(queries[0].first, queries[0].second, false); // fault pages in
+
+        counter.start();
+        double t0 = now_ns();
+        for (auto const& [s, t] : queries)
+            bench_consume(fg.shortest_path(s, t, false).second);
+        double ms = (now_ns() - t0) / 1e6 / queryCount;
+        long long misses = counter.stop();
+
+        cout << left << setw(20) << mode.name << right << fixed << setprecision(2) << setw(14) << ms;
+        if (misses >= 0) cout << setw(20) << misses / queryCount << "\n";
+        else cout << setw(20) << "n/a" << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,223 @@
+// Memory footprint and allocation counts of the graph representations.
+//
+//   memory_footprint [vertices] [edgesPerVertex]
+//
+// The same random graph is built as a Graph (map of adjacency lists), as a
+// FrozenGraph with each page backing, as a NumaGraph with each placement and, if
+// it fits, as a StaticGraph. For each build the table shows:
+//   allocs     heap allocations made by the build (counting global operator new)
+//   heap B/e   heap bytes still held by the structure, per stored adjacency entry
+//              (an undirected edge is stored twice)
+//   RSS B/e    growth of the resident set, per adjacency entry; unlike heap B/e it
+//              includes huge pages mapped outside the heap
+//   peak RSS   process peak resident set (getrusage) after the build
+// Then add_edge and shortest_path are measured in allocations and bytes per call;
+// "transient" is the peak of extra heap bytes in use during one call.
+// Heap and RSS figures need Linux (malloc_usable_size, /proc/self/statm).
+
+#include "BenchCommon.h"
+#include "../NumaGraph.h"
+#include "../StaticGraph.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <memory>
+#include <new>
+#ifdef __linux__
+#include <malloc.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+using namespace std;
+
+// Counting global allocator. Sizes are taken from malloc_usable_size, so frees
+// do not need a header and aligned allocations are counted the same way.
+namespace alloc_stats {
+    atomic<long long> count{ 0 }, bytes{ 0 }, live{ 0 }, peak{ 0 };
+
+    size_t usable(void* p) {
+#ifdef __linux__
+        return malloc_usable_size(p);
+#else
+        (void)p;
+        return 0;
+#endif
+    }
+
+    void* record(void* p) {
+        if (!p) throw bad_alloc();
+        long long size = static_cast<long long>(usable(p));
+        count.fetch_add(1, memory_order_relaxed);
+        bytes.fetch_add(size, memory_order_relaxed);
+        long long now = live.fetch_add(size, memory_order_relaxed) + size;
+        long long seen = peak.load(memory_order_relaxed);
+        while (now > seen && !peak.compare_exchange_weak(seen, now, memory_order_relaxed)) {}
+        return p;
+    }
+
+    void release(void* p) {
+        if (!p) return;
+        live.fetch_sub(static_cast<long long>(usable(p)), memory_order_relaxed);
+        free(p);
+    }
+
+    void* allocate(size_t size) { return record(malloc(size ? size : 1)); }
+    void* allocate(size_t size, align_val_t align) {
+        size_t a = static_cast<size_t>(align);
+        return record(aligned_alloc(a, (max<size_t>(size, 1) + a - 1) / a * a));
+    }
+
+    struct Snapshot {
+        long long count, bytes, live;
+    };
+    Snapshot now() { return { count.load(), bytes.load(), live.load() }; }
+    // Restarts peak tracking from the current live size.
+    void resetPeak() { peak.store(live.load()); }
+}
+
+void* operator new(size_t size) { return alloc_stats::allocate(size); }
+void* operator new[](size_t size) { return alloc_stats::allocate(size); }
+void* operator new(size_t size, align_val_t align) { return alloc_stats::allocate(size, align); }
+void* operator new[](size_t size, align_val_t align) { return alloc_stats::allocate(size, align); }
+void operator delete(void* p) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, size_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, size_t) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete(void* p, size_t, align_val_t) noexcept { alloc_stats::release(p); }
+void operator delete[](void* p, size_t, align_val_t) noexcept { alloc_stats::release(p); }
+
+namespace {
+    long long residentBytes() {
+#ifdef __linux__
+        long long pages = 0, resident = 0;
+        FILE* f = fopen("/proc/self/statm", "r");
+        if (f) {
+            if (fscanf(f, "%lld %lld", &pages, &resident) != 2) resident = 0;
+            fclose(f);
+        }
+        return resident * sysconf(_SC_PAGESIZE);
+#else
+        return 0;
+#endif
+    }
+
+    double peakRssMb() {
+#ifdef __linux__
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0; // kilobytes on Linux
+#else
+        return 0;
+#endif
+    }
+
+    // Returns freed heap pages to the system so RSS deltas of later builds start clean.
+    void trimHeap() {
+#ifdef __linux__
+        malloc_trim(0);
+#endif
+    }
+
+    void printHeader() {
+        cout << left << setw(30) << "representation" << right << setw(12) << "allocs" << setw(12) << "heap B/e"
+             << setw(12) << "RSS B/e" << setw(14) << "peak RSS MB" << "\n";
+    }
+
+    // Builds with `build`, keeps the result alive while the figures are taken.
+    template<typename Build>
+    void measureBuild(const string& name, size_t entries, Build&& build) {
+        trimHeap();
+        long long rss0 = residentBytes();
+        auto before = alloc_stats::now();
+        auto built = build();
+        auto after = alloc_stats::now();
+        long long rss = residentBytes() - rss0;
+        cout << left << setw(30) << name << right << setw(12) << after.count - before.count
+             << setw(12) << static_cast<double>(after.live - before.live) / entries
+             << setw(12) << static_cast<double>(max(0LL, rss)) / entries
+             << setw(14) << peakRssMb() << "\n";
+        bench_consume(built != nullptr);
+    }
+
+    // Allocations, bytes and transient peak per call of fn(i), over `calls` calls.
+    template<typename Fn>
+    void measureCalls(const string& name, int calls, Fn&& fn) {
+        auto before = alloc_stats::now();
+        long long transient = 0;
+        for (int i = 0; i < calls; i++) {
+            long long base = alloc_stats::live.load();
+            alloc_stats::resetPeak();
+            fn(i);
+            transient = max(transient, alloc_stats::peak.load() - base);
+        }
+        auto after = alloc_stats::now();
+        cout << left << setw(30) << name << right << setw(12) << static_cast<double>(after.count - before.count) / calls
+             << setw(14) << static_cast<double>(after.bytes - before.bytes) / calls
+             << setw(14) << transient << "\n";
+    }
+
+    constexpr size_t StaticVertices = 1 << 14, StaticEdges = 1 << 17;
+    using SmallStaticGraph = StaticGraph<StaticVertices, StaticEdges>;
+}
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? atoi(argv[1]) : 100000;
+    int degree = argc > 2 ? atoi(argv[2]) : 4;
+    cout << fixed << setprecision(1);
+
+    Graph<int> g = make_random_graph(vertices, degree, 100, 41);
+    size_t entries = FrozenGraph<int>(g).edge_count();
+    cout << "graph: " << vertices << " vertices, " << entries << " adjacency entries\n\n";
+
+    printHeader();
+    measureBuild("Graph", entries, [&] { return make_unique<Graph<int>>(make_random_graph(vertices, degree, 100, 41)); });
+    const pair<const char*, PageBacking> backings[] = {
+        { "FrozenGraph (default pages)", PageBacking::Default },
+        { "FrozenGraph (THP)", PageBacking::TransparentHuge },
+        { "FrozenGraph (hugetlb)", PageBacking::HugeTLB },
+    };
+    for (auto const& [name, backing] : backings)
+        measureBuild(name, entries, [&, backing = backing] { return make_unique<FrozenGraph<int>>(g, backing); });
+    measureBuild("NumaGraph (replicated)", entries, [&] { return make_unique<NumaGraph<int>>(g, NumaPlacement::Replicated); });
+    measureBuild("NumaGraph (interleaved)", entries, [&] { return make_unique<NumaGraph<int>>(g, NumaPlacement::Interleaved); });
+
+    // StaticGraph stores each edge once, in a fixed array sized by its capacity.
+    FrozenGraph<int> frozen(g);
+    size_t edges = g.isDirected() ? entries : entries / 2;
+    if (static_cast<size_t>(vertices) <= StaticVertices && edges <= StaticEdges) {
+        measureBuild("StaticGraph<16K, 128K>", entries, [&] {
+            auto s = make_unique<SmallStaticGraph>(vertices, g.isDirected());
+            auto const& offsets = frozen.getOffsets();
+            for (int u = 0; u < frozen.vertex_count(); u++)
+                for (int e = offsets[u]; e < offsets[u + 1]; e++) {
+                    int v = frozen.getTargets()[e];
+                    if (g.isDirected() || u <= v) s->add_edge(u, v, frozen.getWeights()[e]);
+                }
+            return s;
+        });
+    }
+    else {
+        cout << "StaticGraph: graph exceeds " << StaticVertices << " vertices / " << StaticEdges << " edges, skipped\n";
+    }
+
+    cout << "\n" << left << setw(30) << "operation" << right << setw(12) << "allocs/call" << setw(14) << "bytes/call"
+         << setw(14) << "transient B" << "\n";
+    BenchRng rng(42);
+    const int edgeCalls = 100000;
+    vector<pair<int, int>> newEdges(edgeCalls);
+    for (auto& e : newEdges) e = { rng.nextInt(0, vertices - 1), rng.nextInt(0, vertices - 1) };
+    Graph<int> growing = g;
+    measureCalls("Graph::add_edge (existing)", edgeCalls, [&](int i) { growing.add_edge(newEdges[i].first, newEdges[i].second, 7); });
+    measureCalls("Graph::add_edge (new vertex)", edgeCalls, [&](int i) { growing.add_edge(vertices + i, newEdges[i].second, 7); });
+
+    const int queries = 50;
+    vector<pair<int, int>> pairs(queries);
+    for (auto& q : pairs) q = { rng.nextInt(0, vertices - 1), rng.nextInt(0, vertices - 1) };
+    measureCalls("Graph::shortest_path", queries, [&](int i) { bench_consume(g.shortest_path(pairs[i].first, pairs[i].second, false).second); });
+    measureCalls("FrozenGraph::shortest_path", queries, [&](int i) { bench_consume(frozen.shortest_path(pairs[i].first, pairs[i].second, false).second); });
+    NumaGraph<int> numa(g, NumaPlacement::Replicated);
+    measureCalls("NumaGraph::shortest_path", queries, [&](int i) { bench_consume(numa.shortest_path(pairs[i].first, pairs[i].second, false).second); });
+    return 0;
+}
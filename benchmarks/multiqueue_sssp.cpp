@@ -0,0 +1,111 @@
+// MultiQueue rank error and parallel SSSP speedup vs. wasted work.
+//
+//   multiqueue_sssp [vertices] [max threads]
+//
+// Part 1 pushes random keys into a MultiQueue and reports the rank of each popped
+// key among the keys still queued (0 = exact minimum).
+// Part 2 compares sequential Dijkstra with parallel_dijkstra and
+// label_correcting_sssp for 1..N threads: time, speedup, and work as queue pops
+// relative to sequential Dijkstra (1.0 = no wasted work).
+
+#include "BenchCommon.h"
+#include "../ParallelSSSP.h"
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+// Fenwick tree over key values, to count keys smaller than a given one.
+class RankCounter {
+    vector<int> tree;
+public:
+    explicit RankCounter(int n) : tree(n + 1, 0) {}
+    void add(int i, int d) { for (i++; i < static_cast<int>(tree.size()); i += i & -i) tree[i] += d; }
+    int less(int i) const { int s = 0; for (; i > 0; i -= i & -i) s += tree[i]; return s; }
+};
+
+// Plain binary-heap Dijkstra, the reference for time and number of pops.
+static pair<vector<long long>, size_t> sequential_dijkstra(const FrozenGraph<int>& g, int s) {
+    const long long INF = numeric_limits<long long>::max();
+    vector<long long> dist(g.vertex_count(), INF);
+    using P = pair<long long, int>;
+    priority_queue<P, vector<P>, greater<P>> pq;
+    size_t pops = 0;
+    dist[s] = 0;
+    pq.push({ 0, s });
+    while (!pq.empty()) {
+        auto [d, u] = pq.top();
+        pq.pop();
+        pops++;
+        if (d > dist[u]) continue;
+        for (int e = g.getOffsets()[u]; e < g.getOffsets()[u + 1]; e++) {
+            int v = g.getTargets()[e];
+            if (d + g.getWeights()[e] < dist[v]) {
+                dist[v] = d + g.getWeights()[e];
+                pq.push({ dist[v], v });
+            }
+        }
+    }
+    for (auto& d : dist) if (d == INF) d = -1;
+    return { dist, pops };
+}
+
+static void rank_error(int threads) {
+    const int n = 200000;
+    MultiQueue<long long, int> mq(threads);
+    RankCounter counter(n);
+    BenchRng rng(1);
+    for (int i = 0; i < n; i++) {
+        int key = rng.nextInt(0, n - 1);
+        mq.push(key, i);
+        counter.add(key, 1);
+    }
+    double sum = 0;
+    int worst = 0;
+    long long key;
+    int value;
+    for (int i = 0; i < n && mq.try_pop(key, value); i++) {
+        int rank = counter.less(static_cast<int>(key));
+        counter.add(static_cast<int>(key), -1);
+        sum += rank;
+        worst = max(worst, rank);
+    }
+    cout << setw(8) << threads << setw(10) << mq.heap_count() << setw(14) << fixed << setprecision(1)
+         << sum / n << setw(12) << worst << "\n";
+}
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? atoi(argv[1]) : 500000;
+    int maxThreads = argc > 2 ? atoi(argv[2]) : max(1, static_cast<int>(thread::hardware_concurrency()));
+
+    cout << "Rank error of popped elements (c = 2)\n";
+    cout << setw(8) << "threads" << setw(10) << "heaps" << setw(14) << "mean rank" << setw(12) << "max rank" << "\n";
+    for (int t = 1; t <= max(8, maxThreads); t *= 2) rank_error(t);
+
+    cout << "\nBuilding graph with " << vertices << " vertices...\n";
+    FrozenGraph<int> fg(make_random_graph(vertices, 4, 1000, 31337));
+
+    sequential_dijkstra(fg, fg.index_of(0)); // warm up caches and page tables
+    double t0 = now_ns();
+    auto [sequentialDist, sequentialPops] = sequential_dijkstra(fg, fg.index_of(0));
+    double baseMs = (now_ns() - t0) / 1e6;
+    cout << "sequential Dijkstra: " << fixed << setprecision(1) << baseMs << " ms, " << sequentialPops << " pops\n\n";
+
+    cout << left << setw(24) << "algorithm" << right << setw(8) << "threads" << setw(12) << "ms"
+         << setw(10) << "speedup" << setw(12) << "work" << "\n";
+    for (long long delta : { 1LL, 100LL }) {
+        for (int t = 1; t <= maxThreads; t *= 2) {
+            t0 = now_ns();
+            auto r = label_correcting_sssp(fg, 0, t, delta);
+            double ms = (now_ns() - t0) / 1e6;
+            if (r.dist != sequentialDist) {
+                cerr << "Distance mismatch\n";
+                return 1;
+            }
+            string name = delta == 1 ? "parallel_dijkstra" : "label_correcting d=" + to_string(delta);
+            cout << left << setw(24) << name << right << setw(8) << t << setw(12) << setprecision(1) << ms
+                 << setw(9) << setprecision(2) << baseMs / ms << "x" << setw(12)
+                 << static_cast<double>(r.processed + r.stale) / sequentialPops << "\n";
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,62 @@
+// Cross-socket scaling of parallel point-to-point searches over one graph.
+//
+// Runs the same query set with 1..N pinned worker threads for three placements:
+//   single       one FrozenGraph built by the main thread (all pages on its node)
+//   interleaved  one copy spread over all nodes by parallel first touch
+//   replicated   one copy per node, each worker queries its local replica
+//
+//   numa_scaling [vertices] [queries]
+
+#include "BenchCommon.h"
+#include "../NumaGraph.h"
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int vertices = argc > 1 ? atoi(argv[1]) : 200000;
+    int queryCount = argc > 2 ? atoi(argv[2]) : 2000;
+    const NumaTopology& topo = NumaTopology::get();
+    int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+
+    cout << "NUMA nodes: " << topo.nodeCount() << ", hardware threads: " << maxThreads << "\n";
+    cout << "Building graph with " << vertices << " vertices...\n";
+    Graph<int> g = make_random_graph(vertices, 4, 100, 2024);
+
+    BenchRng rng(77);
+    vector<pair<int, int>> queries(queryCount);
+    for (auto& q : queries) q = { rng.nextInt(0, vertices - 1), rng.nextInt(0, vertices - 1) };
+
+    FrozenGraph<int> single(g);
+    NumaGraph<int> interleaved(g, NumaPlacement::Interleaved);
+    NumaGraph<int> replicated(g, NumaPlacement::Replicated);
+
+    vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    cout << setw(8) << "threads" << setw(16) << "single q/s" << setw(16) << "interleaved q/s"
+         << setw(16) << "replicated q/s" << setw(12) << "speedup" << "\n";
+
+    double replicatedBase = 0;
+    for (int threads : threadCounts) {
+        NumaWorkerPool pool(threads);
+        auto run = [&](auto const& pick) {
+            double t0 = now_ns();
+            pool.parallel_for(queries.size(), [&](size_t i, int node) {
+                bench_consume(pick(node).shortest_path(queries[i].first, queries[i].second, false).second);
+            });
+            return queries.size() / ((now_ns() - t0) / 1e9);
+        };
+
+        double qsSingle = run([&](int) -> const FrozenGraph<int>& { return single; });
+        double qsInterleaved = run([&](int node) -> const FrozenGraph<int>& { return interleaved.replica(node); });
+        double qsReplicated = run([&](int node) -> const FrozenGraph<int>& { return replicated.replica(node); });
+        if (replicatedBase == 0) replicatedBase = qsReplicated;
+
+        cout << fixed << setprecision(0) << setw(8) << threads << setw(16) << qsSingle << setw(16) << qsInterleaved
+             << setw(16) << qsReplicated << setw(11) << setprecision(2) << qsReplicated / replicatedBase << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,97 @@
+// Size and speed of the path encodings on shortest paths of a road-like grid.
+//
+//   path_codec [routes] [side]
+//
+// Routes are shortest paths between random vertices of a side x side grid; with
+// fewer distinct routes than requested they are repeated (the codec cost does not
+// depend on repetition). Sizes are compared with vector<int> (24-byte header +
+// 4 bytes per vertex); the archive size includes its fixed-width columns.
+
+#include "BenchCommon.h"
+#include "../PathCodec.h"
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int routes = argc > 1 ? atoi(argv[1]) : 1000000;
+    int side = argc > 2 ? atoi(argv[2]) : 300;
+
+    FrozenGraph<int> fg(make_grid_graph(side, side, 10, 61));
+    BenchRng rng(62);
+    vector<vector<int>> distinct;
+    for (int i = 0; i < min(routes, 500); i++)
+        distinct.push_back(fg.shortest_path(rng.nextInt(0, side * side - 1), rng.nextInt(0, side * side - 1), false).first);
+    vector<const vector<int>*> paths(routes);
+    for (int i = 0; i < routes; i++) paths[i] = &distinct[rng.nextInt(0, static_cast<int>(distinct.size()) - 1)];
+
+    size_t vertices = 0, raw = 0;
+    for (auto* p : paths) {
+        vertices += p->size();
+        raw += sizeof(vector<int>) + p->size() * sizeof(int);
+    }
+
+    PathCodec<int> codec(fg);
+    string deltas;
+    double t0 = now_ns();
+    for (auto* p : paths) append_path_delta(*p, deltas);
+    double deltaEncode = now_ns() - t0;
+
+    PathArchiveWriter<int> writer(codec);
+    t0 = now_ns();
+    for (auto* p : paths) writer.add(*p);
+    double archiveEncode = now_ns() - t0;
+    string file = "path_codec_bench.parc";
+    if (!writer.write(file)) {
+        cerr << "cannot write " << file << "\n";
+        return 1;
+    }
+    size_t archiveBytes = 32 + writer.size() * 16 + 8 + writer.payloadBytes();
+
+    vector<int> out;
+    size_t pos = 0;
+    long long check = 0;
+    t0 = now_ns();
+    while (pos < deltas.size() && read_path_delta(deltas, pos, out)) check += static_cast<long long>(out.size());
+    double deltaDecode = now_ns() - t0;
+
+    PathArchive<int> archive(codec);
+    if (!archive.open(file)) {
+        cerr << "cannot open " << file << "\n";
+        return 1;
+    }
+    t0 = now_ns();
+    for (size_t id = 0; id < archive.size(); id++) {
+        archive.get(id, out);
+        check += static_cast<long long>(out.size());
+    }
+    double archiveDecode = now_ns() - t0;
+    const int lookups = 100000;
+    t0 = now_ns();
+    for (int i = 0; i < lookups; i++) {
+        archive.get(static_cast<size_t>(rng.nextInt(0, routes - 1)), out);
+        check += static_cast<long long>(out.size());
+    }
+    double randomAccess = (now_ns() - t0) / lookups;
+    bench_consume(check);
+    archive.close();
+    remove(file.c_str());
+
+    cout << routes << " routes, " << fixed << setprecision(1) << static_cast<double>(vertices) / routes
+         << " vertices per route on a " << side << " x " << side << " grid\n\n";
+    cout << left << setw(22) << "encoding" << right << setw(12) << "MB" << setw(10) << "ratio" << setw(14) << "bits/hop"
+         << setw(14) << "enc ns/hop" << setw(14) << "dec ns/hop" << "\n";
+    size_t hops = vertices - routes;
+    auto row = [&](const string& name, size_t bytes, double encodeNs, double decodeNs) {
+        cout << left << setw(22) << name << right << setw(12) << setprecision(2) << bytes / 1e6
+             << setw(10) << setprecision(1) << static_cast<double>(raw) / bytes
+             << setw(14) << setprecision(2) << bytes * 8.0 / hops
+             << setw(14) << encodeNs / hops << setw(14) << decodeNs / hops << "\n";
+    };
+    row("vector<int>", raw, 0, 0);
+    row("delta + varint", deltas.size(), deltaEncode, deltaDecode);
+    row("edge index (archive)", archiveBytes, archiveEncode, archiveDecode);
+    cout << "\nrandom access: " << setprecision(0) << randomAccess << " ns per route\n";
+    return 0;
+}
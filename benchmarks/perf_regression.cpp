@@ -0,0 +1,194 @@
+// Performance regression runner.
+//
+// Runs a fixed benchmark set on deterministic generated graphs and compares
+// the results with a JSON baseline.
+//
+//   perf_regression --update [--baseline perf_baseline.json]   record a new baseline
+//   perf_regression [--baseline perf_baseline.json]            compare against it
+//
+// Other options: --samples N (default 15), --filter substring, --threshold percent (default 5).
+// A change is reported only when Welch's t-test says it is significant at 95%
+// AND the relative change is above the threshold. Exit code 1 means a regression.
+
+#include "BenchCommon.h"
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <sstream>
+using namespace std;
+
+struct BenchmarkCase {
+    string name;
+    int innerIterations;
+    function<void()> run;
+};
+
+struct BaselineEntry {
+    double mean = 0, stddev = 0;
+    int n = 0;
+};
+
+static vector<BenchmarkCase> make_benchmarks() {
+    // Inputs are built once; each case captures its graph by shared_ptr.
+    auto sparse = make_shared<Graph<int>>(make_random_graph(20000, 4, 100, 42));
+    auto grid = make_shared<Graph<int>>(make_grid_graph(150, 150, 20, 7));
+    auto mstInput = make_shared<Graph<int>>(make_random_graph(5000, 6, 1000, 1234));
+
+    vector<BenchmarkCase> cases;
+    cases.push_back({ "shortest_path/random_20k", 1, [sparse] {
+        bench_consume(sparse->shortest_path(0, 19999, false).second);
+    } });
+    cases.push_back({ "shortest_path/grid_150x150", 1, [grid] {
+        bench_consume(grid->shortest_path(0, 150 * 150 - 1, false).second);
+    } });
+    cases.push_back({ "mst_prim/random_5k", 1, [mstInput] {
+        bench_consume(mstInput->mst_prim(false).second);
+    } });
+    cases.push_back({ "mst_kruskal/random_5k", 1, [mstInput] {
+        bench_consume(mstInput->mst_kruskal(false).second);
+    } });
+    cases.push_back({ "mst_boruvka/random_5k", 1, [mstInput] {
+        bench_consume(mstInput->mst_boruvka(false).second);
+    } });
+    cases.push_back({ "add_edge/random_5k", 1, [] {
+        bench_consume(make_random_graph(5000, 4, 100, 99).getAdjacency().size());
+    } });
+    return cases;
+}
+
+// The baseline file is written by this program only, so the reader just scans
+// for the fields it writes instead of being a general JSON parser.
+static map<string, BaselineEntry> read_baseline(const string& path) {
+    map<string, BaselineEntry> result;
+    ifstream in(path);
+    if (!in) return result;
+    stringstream ss;
+    ss << in.rdbuf();
+    string text = ss.str();
+
+    auto numberAfter = [&text](const string& key, size_t from, size_t to) {
+        size_t k = text.find("\"" + key + "\"", from);
+        if (k == string::npos || k > to) return 0.0;
+        size_t colon = text.find(':', k);
+        return strtod(text.c_str() + colon + 1, nullptr);
+    };
+
+    size_t pos = 0;
+    while ((pos = text.find('{', pos + 1)) != string::npos) {
+        size_t end = text.find('}', pos);
+        if (end == string::npos) break;
+        size_t nameKey = text.find("\"name\"", pos);
+        if (nameKey == string::npos || nameKey > end) continue;
+        size_t q1 = text.find('"', text.find(':', nameKey));
+        size_t q2 = text.find('"', q1 + 1);
+        BaselineEntry e;
+        e.mean = numberAfter("mean_ns", pos, end);
+        e.stddev = numberAfter("stddev_ns", pos, end);
+        e.n = static_cast<int>(numberAfter("samples", pos, end));
+        result[text.substr(q1 + 1, q2 - q1 - 1)] = e;
+        pos = end;
+    }
+    return result;
+}
+
+static void write_baseline(const string& path, const vector<pair<string, SampleStats>>& results) {
+    ofstream out(path);
+    out << setprecision(10);
+    out << "{\n  \"version\": 1,\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto const& [name, st] = results[i];
+        out << "    { \"name\": \"" << name << "\", \"mean_ns\": " << st.mean
+            << ", \"stddev_ns\": " << st.stddev << ", \"median_ns\": " << st.median
+            << ", \"samples\": " << st.n << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// Welch's t statistic and degrees of freedom for two independent samples.
+static pair<double, double> welch(const SampleStats& a, const BaselineEntry& b) {
+    double va = a.stddev * a.stddev / max(1, a.n);
+    double vb = b.stddev * b.stddev / max(1, b.n);
+    double se = sqrt(va + vb);
+    if (se == 0) return { 0, 1 };
+    double t = (a.mean - b.mean) / se;
+    double df = (va + vb) * (va + vb) /
+        ((a.n > 1 ? va * va / (a.n - 1) : 0) + (b.n > 1 ? vb * vb / (b.n - 1) : 0) + 1e-300);
+    return { t, df };
+}
+
+int main(int argc, char** argv) {
+    string baselinePath = "perf_baseline.json";
+    string filter;
+    bool update = false;
+    int samples = 15;
+    double thresholdPercent = 5.0;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--update") update = true;
+        else if (arg == "--baseline" && i + 1 < argc) baselinePath = argv[++i];
+        else if (arg == "--filter" && i + 1 < argc) filter = argv[++i];
+        else if (arg == "--samples" && i + 1 < argc) samples = max(3, atoi(argv[++i]));
+        else if (arg == "--threshold" && i + 1 < argc) thresholdPercent = atof(argv[++i]);
+        else {
+            cerr << "Unknown argument: " << arg << "\n";
+            return 2;
+        }
+    }
+
+    map<string, BaselineEntry> baseline;
+    if (!update) {
+        baseline = read_baseline(baselinePath);
+        if (baseline.empty())
+            cout << "No baseline at " << baselinePath << ", run with --update to create one.\n";
+    }
+
+    vector<pair<string, SampleStats>> results;
+    int regressions = 0;
+
+    cout << left << setw(30) << "benchmark" << right << setw(14) << "mean ms" << setw(20) << "95% CI ms"
+         << setw(10) << "change" << "  verdict\n";
+    cout << fixed << setprecision(3);
+
+    for (auto& bench : make_benchmarks()) {
+        if (!filter.empty() && bench.name.find(filter) == string::npos) continue;
+
+        auto raw = measure_ns(bench.run, samples, bench.innerIterations);
+        SampleStats st = compute_stats(filter_outliers(raw));
+        results.push_back({ bench.name, st });
+
+        cout << left << setw(30) << bench.name << right << setw(14) << st.mean / 1e6
+             << setw(10) << st.ciLow / 1e6 << "-" << left << setw(9) << st.ciHigh / 1e6 << right;
+
+        auto it = baseline.find(bench.name);
+        if (it == baseline.end()) {
+            cout << setw(10) << "-" << "  new\n";
+            continue;
+        }
+        double change = (st.mean - it->second.mean) / it->second.mean * 100.0;
+        auto [t, df] = welch(st, it->second);
+        bool significant = fabs(t) > t_critical_95(df) && fabs(change) > thresholdPercent;
+
+        cout << setw(9) << showpos << change << noshowpos << "%  ";
+        if (!significant) cout << "unchanged\n";
+        else if (change > 0) {
+            cout << "REGRESSION\n";
+            regressions++;
+        }
+        else cout << "improvement\n";
+    }
+
+    if (update) {
+        write_baseline(baselinePath, results);
+        cout << "Baseline written to " << baselinePath << "\n";
+        return 0;
+    }
+    if (regressions > 0) {
+        cout << regressions << " significant regression(s).\n";
+        return 1;
+    }
+    return 0;
+}
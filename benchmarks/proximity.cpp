@@ -0,0 +1,58 @@
+// Per-tick proximity detection at constant vehicle density.
+//
+//   proximity [max_vehicles]
+//
+// For each fleet size the area grows so that a vehicle has about 4 neighbors
+// within the radius on average; reports the time of one findClosePairs and one
+// findObstacleAlerts call, and a brute-force reference for small fleets.
+
+#include "BenchCommon.h"
+#include "../Proximity.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int maxVehicles = argc > 1 ? atoi(argv[1]) : 1000000;
+    const double radius = 1.0;
+    const double neighbors = 4.0;
+
+    cout << left << setw(12) << "vehicles" << right << setw(12) << "pairs" << setw(14) << "pairs ms"
+         << setw(14) << "obstacles ms" << setw(14) << "brute ms" << "\n";
+    cout << fixed << setprecision(2);
+
+    for (int n = 1000; n <= maxVehicles; n *= 10) {
+        double side = sqrt(n * 3.14159 * radius * radius / neighbors);
+        BenchRng rng(n);
+        FleetPositions fleet;
+        for (int i = 0; i < n; i++) fleet.add(rng.nextDouble() * side, rng.nextDouble() * side);
+        vector<Obstacle> obstacles;
+        for (int i = 0; i < n / 100; i++)
+            obstacles.emplace_back("obstacle", rng.nextDouble() * side, rng.nextDouble() * side);
+
+        ProximityDetector detector(radius);
+        detector.findClosePairs(fleet); // warm-up, sizes the buffers
+        double t0 = now_ns();
+        size_t pairCount = detector.findClosePairs(fleet).size();
+        double pairsMs = (now_ns() - t0) / 1e6;
+        t0 = now_ns();
+        bench_consume(detector.findObstacleAlerts(fleet, obstacles).size());
+        double obstaclesMs = (now_ns() - t0) / 1e6;
+
+        cout << left << setw(12) << n << right << setw(12) << pairCount << setw(14) << pairsMs << setw(14) << obstaclesMs;
+        if (n <= 10000) {
+            t0 = now_ns();
+            size_t brute = 0;
+            for (int a = 0; a < n; a++)
+                for (int b = a + 1; b < n; b++) {
+                    double dx = fleet.x[a] - fleet.x[b], dy = fleet.y[a] - fleet.y[b];
+                    brute += dx * dx + dy * dy <= radius * radius;
+                }
+            bench_consume(brute);
+            cout << setw(14) << (now_ns() - t0) / 1e6;
+        }
+        cout << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,51 @@
+// FrozenGraph::shortest_path time with each edge relaxation kernel, by degree.
+//
+//   relax_kernel [edges] [queries]
+//
+// Random directed graphs with about `edges` arcs and a fixed out-degree of 4, 16,
+// 64 and 256; every query searches for an isolated vertex, so all reachable
+// edges are scanned. Kernels the CPU lacks are skipped.
+
+#include "BenchCommon.h"
+#include "../FrozenGraph.h"
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int edges = argc > 1 ? atoi(argv[1]) : 4000000;
+    int queries = argc > 2 ? atoi(argv[2]) : 5;
+
+    const pair<RelaxKernel, const char*> kernels[] = {
+        { RelaxKernel::Scalar, "scalar" }, { RelaxKernel::Avx2, "avx2" }, { RelaxKernel::Avx512, "avx512" } };
+    RelaxKernel initial = active_relax_kernel();
+
+    cout << left << setw(8) << "degree" << setw(10) << "kernel" << right << setw(12) << "ms/query"
+         << setw(12) << "ns/edge" << setw(10) << "speedup" << "\n";
+    for (int degree : { 4, 16, 64, 256 }) {
+        int n = max(2, edges / degree);
+        Graph<int> g(true);
+        BenchRng rng(81 + degree);
+        for (int u = 0; u < n; u++)
+            for (int k = 0; k < degree; k++)
+                g.add_edge(u, rng.nextInt(0, n - 1), rng.nextInt(1, 1000));
+        g.add_vertex(n);
+        FrozenGraph<int> fg(g);
+        g = Graph<int>(true);
+
+        double scalarNs = 0;
+        for (auto [kernel, name] : kernels) {
+            if (!select_relax_kernel(kernel)) continue;
+            int q = 0;
+            double ns = median_of(measure_ns([&] {
+                bench_consume(fg.shortest_path(q % n, n, false).second);
+                q++;
+            }, queries, 1, 1));
+            if (kernel == RelaxKernel::Scalar) scalarNs = ns;
+            cout << left << setw(8) << degree << setw(10) << name << right << fixed << setprecision(2)
+                 << setw(12) << ns / 1e6 << setw(12) << ns / fg.edge_count() << setw(10) << scalarNs / ns << "\n";
+        }
+    }
+    select_relax_kernel(initial);
+    return 0;
+}
@@ -0,0 +1,47 @@
+// Latency of ride-pooling insertion for large fleets.
+//
+//   ride_pooling [vehicles] [requests]
+//
+// Vehicles (cars with 4 seats) are spread over a square city sized so that a
+// vehicle covers about a tenth of it before the pickup deadline. Requests are
+// assigned one after another, so routes fill up as the run goes on.
+
+#include "BenchCommon.h"
+#include "../RidePooling.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+using namespace std;
+
+int main(int argc, char** argv) {
+    int vehicleCount = argc > 1 ? atoi(argv[1]) : 10000;
+    int requestCount = argc > 2 ? atoi(argv[2]) : 5000;
+    const double side = 50.0; // km
+    const double speed = 30.0;
+
+    Car car("Taxi", speed, 4, "Gasoline", 50, 0.08);
+    RidePooling pool(1.0);
+    BenchRng rng(17);
+    for (int i = 0; i < vehicleCount; i++) pool.addVehicle(car, rng.nextDouble() * side, rng.nextDouble() * side);
+
+    vector<double> latencies;
+    latencies.reserve(requestCount);
+    int assigned = 0;
+    for (int id = 0; id < requestCount; id++) {
+        RideRequest r = { id, rng.nextDouble() * side, rng.nextDouble() * side,
+                          rng.nextDouble() * side, rng.nextDouble() * side, 0, 0 };
+        r.latestPickup = 0.15;
+        r.latestDropoff = r.latestPickup + 1.5 * hypot(r.pickupX - r.dropoffX, r.pickupY - r.dropoffY) / speed + 0.1;
+        double t0 = now_ns();
+        assigned += pool.assign(r).feasible();
+        latencies.push_back(now_ns() - t0);
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << fixed << setprecision(1);
+    cout << vehicleCount << " vehicles, " << requestCount << " requests, " << assigned << " assigned\n";
+    cout << "p50 " << latencies[latencies.size() / 2] / 1e3 << " us, p99 "
+         << latencies[latencies.size() * 99 / 100] / 1e3 << " us, max " << latencies.back() / 1e3 << " us\n";
+    return 0;
+}
@@ -0,0 +1,177 @@
+// Strong- and weak-scaling harness for the parallel algorithms.
+//
+//   scaling [--threads N] [--mode strong|weak|both] [--scale F] [--samples K] [--csv path]
+//
+// strong: a fixed input per algorithm, 1..N threads; speedup = T1 / Tp,
+//         efficiency = speedup / p.
+// weak:   the input grows with the thread count (size = base * p);
+//         efficiency = T1 / Tp (1.0 = perfect).
+// idle = 1 - process CPU time / (p * wall time): the share of the p threads'
+// time spent waiting (load imbalance, joins, serial phases). Spinning workers
+// (MultiQueue) count as busy, so idle underestimates imbalance for the SSSP rows.
+//
+// Covered: MultiQueue SSSP (parallel Dijkstra and delta = 64 label correcting),
+// independent shortest-path queries on NumaWorkerPool, DBSCAN, heatmap batches.
+// The graph algorithms without a parallel mode (MST, connected components,
+// matrix construction) are not listed until they get one.
+// Results go to stdout as a table and, with --csv, to a CSV file for plotting.
+
+#include "BenchCommon.h"
+#include "../Dbscan.h"
+#include "../Heatmap.h"
+#include "../NumaGraph.h"
+#include "../ParallelSSSP.h"
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <memory>
+using namespace std;
+
+namespace {
+    // An algorithm prepares its input once per size and is then run with p threads.
+    struct Workload {
+        string name;
+        long long baseSize; // strong-scaling size and weak-scaling size per thread
+        function<function<void(int)>(long long)> prepare;
+    };
+
+    double cpuSeconds() {
+        timespec ts;
+        clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+        return ts.tv_sec + ts.tv_nsec * 1e-9;
+    }
+
+    struct Measurement {
+        double wallMs;
+        double idle;
+    };
+
+    Measurement measure(const function<void(int)>& run, int threads, int samples) {
+        run(threads); // warm-up
+        vector<double> walls, idles;
+        for (int s = 0; s < samples; s++) {
+            double c0 = cpuSeconds(), t0 = now_ns();
+            run(threads);
+            double wall = (now_ns() - t0) / 1e9, cpu = cpuSeconds() - c0;
+            walls.push_back(wall * 1e3);
+            idles.push_back(max(0.0, 1.0 - cpu / (threads * wall)));
+        }
+        return { median_of(walls), median_of(idles) };
+    }
+
+    vector<Workload> workloads(double scale) {
+        auto scaled = [scale](long long n) { return max(1000LL, static_cast<long long>(n * scale)); };
+        vector<Workload> list;
+
+        auto sssp = [](long long delta) {
+            return [delta](long long vertices) -> function<void(int)> {
+                auto fg = make_shared<FrozenGraph<int>>(make_random_graph(static_cast<int>(vertices), 4, 100, 31));
+                return [fg, delta](int threads) {
+                    auto r = delta == 1 ? parallel_dijkstra(*fg, 0, threads) : label_correcting_sssp(*fg, 0, threads, delta);
+                    bench_consume(r.processed);
+                };
+            };
+        };
+        list.push_back({ "parallel_dijkstra", scaled(200000), sssp(1) });
+        list.push_back({ "label_correcting_d64", scaled(200000), sssp(64) });
+
+        // 256 queries per base size: the weak case (vertices = base * p) gets 256 * p
+        // queries, so each thread keeps the same number of queries.
+        long long queryBase = scaled(100000);
+        list.push_back({ "numa_queries", queryBase, [queryBase](long long vertices) -> function<void(int)> {
+            auto g = make_shared<NumaGraph<int>>(make_random_graph(static_cast<int>(vertices), 4, 100, 32));
+            auto queries = make_shared<vector<pair<int, int>>>(static_cast<size_t>(256 * vertices / queryBase));
+            BenchRng rng(5);
+            for (auto& q : *queries) q = { rng.nextInt(0, static_cast<int>(vertices) - 1), rng.nextInt(0, static_cast<int>(vertices) - 1) };
+            return [g, queries](int threads) {
+                NumaWorkerPool pool(threads);
+                atomic<long long> total{ 0 };
+                pool.parallel_for(queries->size(), [&](size_t i, int node) {
+                    auto const& [s, t] = (*queries)[i];
+                    total += g->replica(node).shortest_path(s, t, false).second;
+                });
+                bench_consume(total.load());
+            };
+        } });
+
+        list.push_back({ "dbscan", scaled(1000000), [](long long points) -> function<void(int)> {
+            auto xs = make_shared<vector<double>>(), ys = make_shared<vector<double>>();
+            BenchRng rng(6);
+            double side = sqrt(static_cast<double>(points)); // constant density
+            for (long long i = 0; i < points; i++) {
+                xs->push_back(rng.nextDouble() * side);
+                ys->push_back(rng.nextDouble() * side);
+            }
+            return [xs, ys](int threads) { bench_consume(dbscan(*xs, *ys, 0.5, 4, threads).clusterCount); };
+        } });
+
+        list.push_back({ "heatmap_batch", scaled(4000000), [](long long positions) -> function<void(int)> {
+            auto fleet = make_shared<FleetPositions>();
+            BenchRng rng(7);
+            for (long long i = 0; i < positions; i++) fleet->add(rng.nextDouble() * 100, rng.nextDouble() * 100);
+            auto heatmap = make_shared<Heatmap>(0, 0, 100, 100, 512);
+            return [fleet, heatmap](int threads) { heatmap->recordBatch(*fleet, threads); };
+        } });
+        return list;
+    }
+}
+
+int main(int argc, char** argv) {
+    int maxThreads = max(1, static_cast<int>(thread::hardware_concurrency()));
+    string mode = "both", csvPath;
+    double scale = 1.0;
+    int samples = 3;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        auto value = [&]() { return i + 1 < argc ? string(argv[++i]) : string(); };
+        if (arg == "--threads") maxThreads = max(1, atoi(value().c_str()));
+        else if (arg == "--mode") mode = value();
+        else if (arg == "--scale") scale = atof(value().c_str());
+        else if (arg == "--samples") samples = max(1, atoi(value().c_str()));
+        else if (arg == "--csv") csvPath = value();
+        else {
+            cerr << "usage: scaling [--threads N] [--mode strong|weak|both] [--scale F] [--samples K] [--csv path]\n";
+            return 2;
+        }
+    }
+
+    vector<int> threadCounts;
+    for (int t = 1; t < maxThreads; t *= 2) threadCounts.push_back(t);
+    threadCounts.push_back(maxThreads);
+
+    ofstream csv;
+    if (!csvPath.empty()) {
+        csv.open(csvPath);
+        csv << "mode,algorithm,threads,size,time_ms,speedup,efficiency,idle\n";
+    }
+    cout << fixed << setprecision(3);
+    cout << left << setw(8) << "mode" << setw(22) << "algorithm" << right << setw(8) << "threads" << setw(11) << "size"
+         << setw(12) << "time ms" << setw(9) << "speedup" << setw(11) << "efficiency" << setw(8) << "idle" << "\n";
+
+    for (auto const& w : workloads(scale)) {
+        for (string m : { "strong", "weak" }) {
+            if (mode != "both" && mode != m) continue;
+            bool strong = m == "strong";
+            function<void(int)> fixedRun;
+            if (strong) fixedRun = w.prepare(w.baseSize);
+            double t1 = 0;
+            for (int p : threadCounts) {
+                long long size = strong ? w.baseSize : w.baseSize * p;
+                Measurement r = measure(strong ? fixedRun : w.prepare(size), p, samples);
+                if (p == 1) t1 = r.wallMs;
+                double speedup = t1 / r.wallMs;
+                double efficiency = strong ? speedup / p : speedup;
+                cout << left << setw(8) << m << setw(22) << w.name << right << setw(8) << p << setw(11) << size
+                     << setw(12) << r.wallMs << setw(9) << (strong ? speedup : 0.0) << setw(11) << efficiency
+                     << setw(8) << r.idle << "\n";
+                if (csv.is_open())
+                    csv << m << "," << w.name << "," << p << "," << size << "," << r.wallMs << ","
+                        << (strong ? speedup : 0.0) << "," << efficiency << "," << r.idle << "\n";
+            }
+        }
+    }
+    return 0;
+}
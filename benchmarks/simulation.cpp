@@ -0,0 +1,109 @@
+// Throughput of the Transport hierarchy and the Environment simulation pipeline.
+//
+//   simulation [max_fleet]
+//
+// 1. move / accelerate / brake per vehicle class, called through Transport&.
+// 2. Environment::findOptimalRoute + moveTransport on a 100 x 100 road grid.
+// 3. Fleet ticks: every vehicle of a mixed fleet moves once, 1k..max_fleet vehicles.
+// Console output of the simulation is discarded (CoutSilencer) but still formatted,
+// so logging cost is part of the numbers.
+
+#include "BenchCommon.h"
+#include "../Environment.h"
+#include "../Transport.h"
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <memory>
+using namespace std;
+
+namespace {
+    // Fuel tanks large enough that no vehicle runs dry during a run.
+    constexpr double Tank = 1e15;
+
+    unique_ptr<Transport> makeVehicle(int kind, int id) {
+        string name = "V" + to_string(id);
+        switch (kind % 4) {
+        case 0: return make_unique<Car>(name, 120, 4, "Gasoline", Tank, 0.08);
+        case 1: return make_unique<Train>(name, 200, 16, 8, Tank, 2.0);
+        case 2: return make_unique<Yacht>(name, 50, "diesel", 4, Tank, 1.0);
+        default: return make_unique<Helicopter>(name, 250, 3000, 4, Tank, 1.0);
+        }
+    }
+
+    const char* kindName(int kind) {
+        static const char* names[] = { "Car", "Train", "Yacht", "Helicopter" };
+        return names[kind % 4];
+    }
+
+    void printRow(const string& label, double nsPerOp) {
+        cout << left << setw(34) << label << right << setw(12) << nsPerOp << setw(14) << 1e9 / nsPerOp << "\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    int maxFleet = argc > 1 ? atoi(argv[1]) : 1000000;
+    cout << fixed << setprecision(1);
+
+    cout << left << setw(34) << "operation" << right << setw(12) << "ns/op" << setw(14) << "ops/s" << "\n";
+    for (int kind = 0; kind < 4; kind++) {
+        unique_ptr<Transport> vehicle = makeVehicle(kind, 0);
+        Transport& t = *vehicle;
+        vector<pair<string, function<void()>>> ops = {
+            { "move", [&t]() { t.move(0.001); } },
+            { "accelerate", [&t]() { t.accelerate(0.001); } },
+            { "brake", [&t]() { t.brake(0.001); } },
+        };
+        for (auto& [op, fn] : ops) {
+            SampleStats stats;
+            {
+                CoutSilencer quiet;
+                stats = compute_stats(measure_ns(fn, 15, 20000));
+            }
+            printRow(string(kindName(kind)) + "::" + op, stats.median);
+        }
+    }
+
+    {
+        const int side = 100;
+        Graph<int> graph = make_grid_graph(side, side, 10, 5);
+        Environment env;
+        Car car("Router", 90, 4, "Gasoline", Tank, 0.08);
+        BenchRng rng(9);
+        vector<pair<int, int>> queries(64);
+        for (auto& q : queries) q = { rng.nextInt(0, side * side - 1), rng.nextInt(0, side * side - 1) };
+        size_t next = 0;
+        SampleStats stats;
+        {
+            CoutSilencer quiet;
+            stats = compute_stats(measure_ns([&]() {
+                auto const& [s, e] = queries[next++ % queries.size()];
+                env.moveTransport(car, env.findOptimalRoute(graph, s, e, car));
+            }, 10, 8));
+        }
+        printRow("findOptimalRoute+moveTransport", stats.median);
+    }
+
+    cout << "\n" << left << setw(12) << "fleet" << right << setw(14) << "ms/tick" << setw(16) << "ns/vehicle" << "\n";
+    for (int fleetSize = 1000; fleetSize <= maxFleet; fleetSize *= 10) {
+        vector<unique_ptr<Transport>> fleet;
+        fleet.reserve(fleetSize);
+        // Interleaved kinds: the virtual calls in a tick are not predictable per class.
+        BenchRng rng(fleetSize);
+        for (int i = 0; i < fleetSize; i++) fleet.push_back(makeVehicle(rng.nextInt(0, 3), i));
+
+        SampleStats stats;
+        {
+            CoutSilencer quiet;
+            stats = compute_stats(measure_ns([&]() {
+                for (auto& v : fleet) v->move(v->getSpeed() / 3600.0); // one second of driving
+            }, fleetSize >= 1000000 ? 3 : 7, 1, 1));
+        }
+        double position = 0;
+        for (auto const& v : fleet) position += v->getPosition();
+        bench_consume(position);
+        cout << left << setw(12) << fleetSize << right << setw(14) << stats.median / 1e6
+             << setw(16) << stats.median / fleetSize << "\n";
+    }
+    return 0;
+}
@@ -2,7 +2,31 @@
 #include "Graph.h"
 #include "Transport.h"
 #include "Environment.h"
+#include "Trace.h"
+#include "Metrics.h"
+#include "FrozenGraph.h"
+#include "NumaGraph.h"
+#include "PageAllocator.h"
+#include "ParallelSSSP.h"
+#include "StaticGraph.h"
+#include "DenseMST.h"
+#include "MSTSensitivity.h"
+#include "Proximity.h"
+#include "RidePooling.h"
+#include "TiledEnvironment.h"
+#include "Dbscan.h"
+#include "Heatmap.h"
+#include "GraphExport.h"
+#include "OsmImport.h"
+#include "PathCodec.h"
+#include "GraphDelta.h"
+#include "EdgeRelax.h"
 #include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
 
 class GraphTestFixture : public ::testing::Test {
 protected:
@@ -413,4 +437,1310 @@ TEST_F(EnvironmentTestFixture, MoveTransportPrintsContainsRouteInfo) {
     std::string output = oss.str();
     EXPECT_NE(output.find("TestCar"), std::string::npos);
     EXPECT_NE(output.find("route"), std::string::npos);
-}
\ No newline at end of file
+}
+TEST(TraceTest, SpansAreExportedAsChromeJson) {
+    Tracer::clear();
+    {
+        TraceSpan span("test", "outer");
+        TraceSpan inner("test", "inner");
+    }
+
+    std::string json = Tracer::toChromeJson();
+    EXPECT_NE(json.find("\"traceEvents\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"outer\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"inner\""), std::string::npos);
+    EXPECT_NE(json.find("\"ph\":\"X\""), std::string::npos);
+
+    // Control characters in names are escaped, not written raw.
+    Tracer::clear();
+    { TraceSpan span("test", "tab\there"); }
+    json = Tracer::toChromeJson();
+    EXPECT_NE(json.find("tab\\u0009here"), std::string::npos);
+    EXPECT_EQ(json.find('\t'), std::string::npos);
+
+    Tracer::clear();
+    EXPECT_EQ(Tracer::toChromeJson().find("outer"), std::string::npos);
+
+    // Buffers of exited threads keep their events until exported, then are reused.
+    size_t buffers = Tracer::bufferCount();
+    std::thread([] { TraceSpan span("test", "first"); }).join();
+    std::thread([] { TraceSpan span("test", "second"); }).join();
+    json = Tracer::toChromeJson();
+    EXPECT_NE(json.find("\"name\":\"first\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"second\""), std::string::npos);
+    for (int i = 0; i < 8; i++) {
+        std::thread([] { TraceSpan span("test", "worker"); }).join();
+        EXPECT_NE(Tracer::toChromeJson().find("\"name\":\"worker\""), std::string::npos);
+    }
+    EXPECT_LE(Tracer::bufferCount(), buffers + 2);
+}
+
+TEST(MetricsTest, HistogramBucketsBoundRelativeError) {
+    for (uint64_t v : { 0ull, 1ull, 31ull, 32ull, 100ull, 12345ull, 987654321ull }) {
+        int i = LatencyHistogram::bucketIndex(v);
+        EXPECT_LE(LatencyHistogram::bucketLowerBound(i), v);
+        EXPECT_GE(LatencyHistogram::bucketUpperBound(i), v);
+        EXPECT_LE(LatencyHistogram::bucketUpperBound(i) - LatencyHistogram::bucketLowerBound(i), v / 32 + 1);
+    }
+    EXPECT_LT(LatencyHistogram::bucketIndex(~0ull), LatencyHistogram::BucketCount);
+}
+
+TEST(MetricsTest, PercentilesMergeAcrossThreads) {
+    LatencyHistogram& h = Metrics::histogram("test_operation");
+    h.reset();
+    std::thread worker([&h] {
+        for (uint64_t v = 1; v <= 500; v++) h.record(v * 1000);
+    });
+    for (uint64_t v = 501; v <= 1000; v++) h.record(v * 1000);
+    worker.join();
+
+    HistogramSnapshot snap = h.snapshot();
+    EXPECT_EQ(snap.count, 1000u);
+    EXPECT_NEAR(static_cast<double>(snap.percentile(0.5)), 500000.0, 500000.0 * 0.04);
+    EXPECT_NEAR(static_cast<double>(snap.percentile(0.99)), 990000.0, 990000.0 * 0.04);
+    EXPECT_EQ(snap.max, 1000000u);
+
+    std::string text = Metrics::prometheusText();
+    EXPECT_NE(text.find("latency_seconds_count{operation=\"test_operation\"} 1000"), std::string::npos);
+    EXPECT_NE(text.find("quantile=\"0.999\""), std::string::npos);
+}
+
+TEST(MetricsTest, ShardsOfExitedThreadsAreReused) {
+    LatencyHistogram& h = Metrics::histogram("test_reused_shards");
+    for (int i = 0; i < 8; i++)
+        std::thread([&h] { h.record(1000); }).join();
+    EXPECT_EQ(h.shardCount(), 1u);
+    EXPECT_EQ(h.snapshot().count, 8u);
+}
+
+TEST(FrozenGraphTest, MatchesGraphShortestPath) {
+    Graph<int> g(true);
+    g.add_edge(1, 2, 2);
+    g.add_edge(2, 3, 3);
+    g.add_edge(1, 3, 10);
+    g.add_edge(3, 4, 1);
+    g.add_vertex(5);
+
+    FrozenGraph<int> fg(g);
+    EXPECT_EQ(fg.vertex_count(), 5);
+    EXPECT_EQ(fg.edge_count(), 4u);
+
+    auto [path, dist] = fg.shortest_path(1, 4, false);
+    EXPECT_EQ(dist, 6);
+    EXPECT_EQ(path, (std::vector<int>{ 1, 2, 3, 4 }));
+
+    EXPECT_EQ(fg.shortest_path(1, 5, false).second, -1);
+    EXPECT_EQ(fg.shortest_path(1, 99, false).second, -1);
+}
+
+TEST(NumaGraphTest, ReplicasAnswerLikeTheSourceGraph) {
+    Graph<int> g(false);
+    for (int i = 0; i < 100; i++)
+        g.add_edge(i, (i * 37 + 11) % 100, i % 7 + 1);
+
+    for (NumaPlacement mode : { NumaPlacement::Replicated, NumaPlacement::Interleaved }) {
+        NumaGraph<int> ng(g, mode);
+        // Replicas only for nodes with CPUs; memory-only nodes get no copy of their own.
+        auto const& computeNodes = NumaTopology::get().computeNodes();
+        EXPECT_EQ(ng.replicaCount(), mode == NumaPlacement::Replicated ? static_cast<int>(computeNodes.size()) : 1);
+        for (int node = 0; node < NumaTopology::get().nodeCount(); node++)
+            EXPECT_EQ(ng.replica(node).shortest_path(0, 42, false).second, g.shortest_path(0, 42, false).second);
+        EXPECT_EQ(ng.shortest_path(3, 77, false), g.shortest_path(3, 77, false));
+    }
+    // Workers only go to nodes they can be pinned to.
+    for (int w = 0; w < 16; w++)
+        EXPECT_FALSE(NumaTopology::get().cpusOfNode(NumaWorkerPool::nodeOfWorker(w)).empty());
+}
+
+TEST(PageAllocatorTest, HugeBackedFrozenGraphMatchesDefault) {
+    Graph<int> g(false);
+    for (int i = 0; i < 300000; i++)
+        g.add_edge(i, (i + 1) % 300000, i % 9 + 1);
+
+    FrozenGraph<int> regular(g);
+    for (PageBacking backing : { PageBacking::TransparentHuge, PageBacking::HugeTLB }) {
+        FrozenGraph<int> huge(g, backing);
+        EXPECT_EQ(huge.getPageBacking(), backing);
+        EXPECT_EQ(huge.shortest_path(0, 150000, false), regular.shortest_path(0, 150000, false));
+    }
+}
+
+TEST(PageAllocatorTest, LargeBlocksAreHugePageAligned) {
+    size_t bytes = 3 * HugePageSize + 123;
+    void* p = allocate_pages(bytes, PageBacking::TransparentHuge);
+    ASSERT_NE(p, nullptr);
+    static_cast<char*>(p)[bytes - 1] = 1;
+#ifdef __linux__
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % HugePageSize, 0u);
+#endif
+    free_pages(p, bytes, PageBacking::TransparentHuge);
+}
+
+TEST(FrozenGraphTest, BatchedQueriesMatchSingleQueries) {
+    Graph<int> g(false);
+    for (int i = 0; i < 500; i++) {
+        g.add_edge(i, (i * 31 + 7) % 500, i % 13 + 1);
+        g.add_edge(i, (i + 1) % 500, 20);
+    }
+    g.add_vertex(1000); // isolated
+
+    FrozenGraph<int> fg(g);
+    std::vector<std::pair<int, int>> queries;
+    for (int i = 0; i < 40; i++)
+        queries.push_back({ (i * 17) % 500, (i * 101 + 3) % 500 });
+    queries.push_back({ 0, 1000 });
+    queries.push_back({ 0, 12345 });
+    queries.push_back({ 5, 5 });
+
+    for (int width : { 1, 3, 8 }) {
+        auto results = fg.shortest_paths_batch(queries, width);
+        ASSERT_EQ(results.size(), queries.size());
+        for (size_t i = 0; i < queries.size(); i++) {
+            auto expected = fg.shortest_path(queries[i].first, queries[i].second, false);
+            EXPECT_EQ(results[i].second, expected.second) << "query " << i;
+            if (expected.second >= 0) {
+                EXPECT_EQ(results[i].first.front(), queries[i].first);
+                EXPECT_EQ(results[i].first.back(), queries[i].second);
+            }
+        }
+    }
+}
+
+TEST(FrozenGraphTest, MultiSourceBfsMatchesSingleBfs) {
+    Graph<int> g(true);
+    for (int i = 0; i < 300; i++) {
+        g.add_edge(i, (i * 7 + 1) % 300, 5);
+        if (i % 3 == 0) g.add_edge(i, (i + 50) % 300, 9);
+    }
+    g.add_vertex(999);
+    FrozenGraph<int> fg(g);
+
+    std::vector<int> sources;
+    for (int i = 0; i < 300; i += 2) sources.push_back(i); // 150 sources -> 256-bit masks
+    sources.push_back(999);
+
+    auto hops = fg.multi_source_bfs(sources);
+    ASSERT_EQ(hops.size(), sources.size());
+
+    auto const& off = fg.getOffsets();
+    auto const& tgt = fg.getTargets();
+    for (size_t i = 0; i < sources.size(); i++) {
+        std::vector<int> expected(fg.vertex_count(), -1);
+        std::queue<int> q;
+        int s = fg.index_of(sources[i]);
+        expected[s] = 0;
+        q.push(s);
+        while (!q.empty()) {
+            int u = q.front();
+            q.pop();
+            for (int e = off[u]; e < off[u + 1]; e++)
+                if (expected[tgt[e]] < 0) {
+                    expected[tgt[e]] = expected[u] + 1;
+                    q.push(tgt[e]);
+                }
+        }
+        EXPECT_EQ(hops[i], expected) << "source " << sources[i];
+    }
+}
+
+TEST(ParallelSsspTest, MatchesSequentialDijkstra) {
+    Graph<int> g(true);
+    for (int i = 0; i < 2000; i++) {
+        g.add_edge(i, (i * 13 + 5) % 2000, i % 17 + 1);
+        g.add_edge(i, (i + 1) % 2000, 50);
+    }
+    g.add_vertex(5000);
+    FrozenGraph<int> fg(g);
+
+    for (long long delta : { 1LL, 10LL }) {
+        for (int threads : { 1, 4 }) {
+            auto r = label_correcting_sssp(fg, 0, threads, delta);
+            ASSERT_EQ(r.dist.size(), static_cast<size_t>(fg.vertex_count()));
+            for (int v : { 1, 77, 1234, 1999 })
+                EXPECT_EQ(r.dist[fg.index_of(v)], fg.shortest_path(0, v, false).second);
+            EXPECT_EQ(r.dist[fg.index_of(5000)], -1);
+            EXPECT_GE(r.processed, 2000u);
+        }
+    }
+}
+
+TEST(MultiQueueTest, PopsEverythingPushed) {
+    MultiQueue<long long, int> mq(4);
+    for (int i = 0; i < 1000; i++) mq.push(i % 97, i);
+    std::vector<bool> seen(1000, false);
+    long long key;
+    int value;
+    int popped = 0;
+    while (mq.try_pop(key, value)) {
+        EXPECT_EQ(key, value % 97);
+        seen[value] = true;
+        popped++;
+    }
+    EXPECT_EQ(popped, 1000);
+}
+
+constexpr StaticGraph<6, 10> make_static_network() {
+    StaticGraph<6, 10> g(6);
+    g.add_edge(0, 1, 7);
+    g.add_edge(0, 2, 9);
+    g.add_edge(0, 5, 14);
+    g.add_edge(1, 2, 10);
+    g.add_edge(1, 3, 15);
+    g.add_edge(2, 3, 11);
+    g.add_edge(2, 5, 2);
+    g.add_edge(3, 4, 6);
+    g.add_edge(4, 5, 9);
+    return g;
+}
+
+TEST(StaticGraphTest, RoutingTableIsComputedAtCompileTime) {
+    constexpr auto network = make_static_network();
+    constexpr auto table = all_pairs_routing(network);
+    static_assert(table.distance(0, 4) == 20, "0 -> 2 -> 5 -> 4");
+    static_assert(table.next_hop(0, 4) == 2, "first hop towards 4");
+    static_assert(table.distance(3, 3) == 0, "self distance");
+
+    EXPECT_EQ(table.route(0, 4), (std::vector<int>{ 0, 2, 5, 4 }));
+    Graph<int> runtime = network.to_graph();
+    for (int u = 0; u < 6; u++)
+        for (int v = 0; v < 6; v++)
+            EXPECT_EQ(table.distance(u, v), runtime.shortest_path(u, v, false).second);
+
+    // Capacity beyond vertex_count() reads as unreachable, not as distance 0.
+    constexpr auto partial = all_pairs_routing([] {
+        StaticGraph<8, 4> g(3);
+        g.add_edge(0, 1, 5);
+        return g;
+    }());
+    static_assert(partial.distance(0, 1) == 5, "in range");
+    static_assert(partial.distance(0, 2) == -1, "unreachable vertex");
+    static_assert(partial.distance(0, 6) == -1 && partial.distance(7, 7) == -1, "past vertex_count()");
+    EXPECT_TRUE(partial.route(0, 6).empty());
+}
+
+TEST(StaticGraphTest, KruskalIsComputedAtCompileTime) {
+    constexpr auto mst = mst_kruskal(make_static_network());
+    static_assert(mst.edgeCount == 5, "spanning tree of 6 vertices");
+    static_assert(mst.totalWeight == 33, "7 + 9 + 2 + 6 + 9");
+    EXPECT_EQ(mst.totalWeight, make_static_network().to_graph().mst_kruskal(false).second);
+}
+
+TEST(DenseMSTTest, MatrixPrimMatchesGraphPrim) {
+    const int n = 40;
+    std::vector<double> weights(n * n, -1);
+    Graph<int> g(false);
+    for (int u = 0; u < n; u++)
+        for (int v = u + 1; v < n; v++) {
+            int w = (u * 131 + v * 71) % 97 + 1;
+            weights[u * n + v] = weights[v * n + u] = w;
+            g.add_edge(u, v, w);
+        }
+
+    auto [edges, total] = mst_prim_dense(weights, n);
+    EXPECT_EQ(edges.size(), static_cast<size_t>(n - 1));
+    EXPECT_DOUBLE_EQ(total, g.mst_prim(false).second);
+}
+
+TEST(DenseMSTTest, PointsPrimMatchesMatrixOfDistances) {
+    std::vector<Point> points;
+    for (int i = 0; i < 123; i++)
+        points.emplace_back("P" + std::to_string(i), (i * 37) % 101, (i * 53) % 89 + 0.5 * i);
+
+    const int n = static_cast<int>(points.size());
+    std::vector<double> weights(n * n);
+    for (int u = 0; u < n; u++)
+        for (int v = 0; v < n; v++)
+            weights[u * n + v] = std::hypot(points[u].getX() - points[v].getX(), points[u].getY() - points[v].getY());
+
+    auto [edges, total] = mst_prim_dense(points);
+    EXPECT_EQ(edges.size(), static_cast<size_t>(n - 1));
+    EXPECT_NEAR(total, mst_prim_dense(weights, n).second, 1e-6);
+}
+
+TEST(DenseMSTTest, ArgminFindsSmallest) {
+    std::vector<double> values(1003);
+    for (size_t i = 0; i < values.size(); i++) values[i] = static_cast<double>((i * 7919) % 1009);
+    values[517] = -3;
+    EXPECT_EQ(dense_argmin(values.data(), static_cast<int>(values.size())), 517);
+    EXPECT_EQ(dense_argmin(values.data(), 0), -1);
+}
+
+TEST(MSTSensitivityTest, ImprovementMatchesRerunningKruskal) {
+    Graph<int> g(false);
+    for (int i = 0; i < 60; i++) {
+        g.add_edge(i, (i * 7 + 3) % 60, (i * 13) % 29 + 1);
+        g.add_edge(i, (i + 1) % 60, (i * 5) % 31 + 10);
+    }
+    MSTSensitivity<int> index(g);
+    int base = g.mst_kruskal(false).second;
+    EXPECT_EQ(index.getTotalWeight(), base);
+
+    for (int k = 0; k < 40; k++) {
+        int u = (k * 11) % 60, v = (k * 23 + 7) % 60, w = k % 15 + 1;
+        if (u == v) continue;
+        Graph<int> candidate = g;
+        candidate.add_edge(u, v, w);
+        int rerun = candidate.mst_kruskal(false).second;
+        EXPECT_EQ(index.improvement(u, v, w), base - rerun) << u << "-" << v << " w=" << w;
+        EXPECT_EQ(index.improves(u, v, w), rerun < base);
+    }
+}
+
+TEST(MSTSensitivityTest, TolerancesOfTreeAndNonTreeEdges) {
+    Graph<int> g(false);
+    g.add_edge(1, 2, 1);
+    g.add_edge(2, 3, 2);
+    g.add_edge(1, 3, 5);
+    g.add_edge(3, 4, 7); // bridge
+
+    MSTSensitivity<int> index(g);
+    EXPECT_EQ(index.path_max(1, 4), 7);
+    EXPECT_EQ(index.path_max(1, 3), 2);
+
+    for (auto const& e : index.sensitivity()) {
+        std::pair<int, int> key = { std::min(e.u, e.v), std::max(e.u, e.v) };
+        if (key == std::make_pair(1, 3)) {
+            EXPECT_FALSE(e.inTree);
+            EXPECT_EQ(e.tolerance, 3); // 5 - max(1, 2)
+        }
+        else if (key == std::make_pair(3, 4)) {
+            EXPECT_TRUE(e.inTree);
+            EXPECT_EQ(e.tolerance, MSTSensitivity<int>::Unbounded);
+        }
+        else {
+            EXPECT_TRUE(e.inTree);
+            EXPECT_EQ(e.tolerance, 5 - e.weight); // replaced by 1-3
+        }
+    }
+}
+
+TEST(ProximityTest, ClosePairsMatchBruteForce) {
+    FleetPositions fleet;
+    unsigned state = 7;
+    auto next = [&state]() { state = state * 1103515245u + 12345u; return (state >> 8) % 10000 / 100.0; };
+    for (int i = 0; i < 600; i++) fleet.add(next(), next());
+    fleet.add(fleet.x[0], fleet.y[0]); // exact duplicate
+    fleet.add(-5.0, 3.0);              // negative coordinates
+
+    ProximityDetector detector(2.5);
+    std::set<std::pair<int, int>> found;
+    for (auto const& p : detector.findClosePairs(fleet)) {
+        EXPECT_LT(p.a, p.b);
+        EXPECT_TRUE(found.insert({ p.a, p.b }).second) << "duplicate pair";
+    }
+
+    std::set<std::pair<int, int>> expected;
+    for (int a = 0; a < (int)fleet.size(); a++)
+        for (int b = a + 1; b < (int)fleet.size(); b++)
+            if (std::hypot(fleet.x[a] - fleet.x[b], fleet.y[a] - fleet.y[b]) <= 2.5) expected.insert({ a, b });
+    EXPECT_EQ(found, expected);
+}
+
+TEST(ProximityTest, ObstacleAlerts) {
+    FleetPositions fleet;
+    fleet.add(0, 0);
+    fleet.add(10, 10);
+    fleet.add(100, 100);
+    std::vector<Obstacle> obstacles = { Obstacle("Storm", 1, 1), Obstacle("Jam", 10, 12.5), Obstacle("Rock", 50, 50) };
+
+    ProximityDetector detector(3);
+    std::set<std::pair<int, int>> found;
+    for (auto const& a : detector.findObstacleAlerts(fleet, obstacles)) found.insert({ a.vehicle, a.obstacle });
+    std::set<std::pair<int, int>> expected = { { 0, 0 }, { 1, 1 } };
+    EXPECT_EQ(found, expected);
+    EXPECT_TRUE(detector.findClosePairs(fleet).empty());
+}
+
+TEST(RidePoolingTest, BestInsertionMatchesExhaustiveSearch) {
+    // Straight-line simulation of a full stop list: feasible and total length.
+    auto simulate = [](double x, double y, double t, int onboard, int capacity, double speed,
+                        const std::vector<RideStop>& stops, double& length) {
+        length = 0;
+        for (auto const& s : stops) {
+            double d = std::hypot(s.x - x, s.y - y);
+            length += d;
+            t += d / speed;
+            onboard += s.pickup ? 1 : -1;
+            if (t > s.deadline + 1e-9 || onboard > capacity) return false;
+            x = s.x;
+            y = s.y;
+        }
+        return true;
+    };
+
+    Car car("Taxi", 40, 4, "Gasoline", 50, 0.08, 2);
+    Helicopter heli("Heli", 120, 1000, 3, 500, 1.0);
+    EXPECT_EQ(car.getSeats(), 2);
+    EXPECT_EQ(heli.getCapacity(), 3);
+
+    RidePooling pool(2.0);
+    std::vector<std::pair<double, double>> starts = { { 0, 0 }, { 5, 5 }, { -3, 4 }, { 8, -2 } };
+    for (size_t i = 0; i < starts.size(); i++)
+        pool.addVehicle(i % 2 ? static_cast<const Transport&>(heli) : car, starts[i].first, starts[i].second);
+
+    unsigned state = 3;
+    auto next = [&state]() { state = state * 1103515245u + 12345u; return (state >> 8) % 2000 / 100.0 - 10; };
+    for (int id = 0; id < 25; id++) {
+        RideRequest r = { id, next(), next(), next(), next(), 0, 0 };
+        r.latestPickup = 0.3 + id * 0.02;
+        r.latestDropoff = r.latestPickup + 0.4;
+
+        double bestAdded = std::numeric_limits<double>::infinity();
+        for (int v = 0; v < pool.vehicleCount(); v++) {
+            const Transport& t = v % 2 ? static_cast<const Transport&>(heli) : car;
+            std::vector<RideStop> stops = pool.getStops(v);
+            double base;
+            simulate(starts[v].first, starts[v].second, 0, 0, t.getCapacity(), t.getSpeed(), stops, base);
+            for (size_t i = 0; i <= stops.size(); i++) {
+                for (size_t j = i; j <= stops.size(); j++) {
+                    std::vector<RideStop> trial = stops;
+                    trial.insert(trial.begin() + j, { id, false, r.dropoffX, r.dropoffY, r.latestDropoff });
+                    trial.insert(trial.begin() + i, { id, true, r.pickupX, r.pickupY, r.latestPickup });
+                    double length;
+                    if (simulate(starts[v].first, starts[v].second, 0, 0, t.getCapacity(), t.getSpeed(), trial, length))
+                        bestAdded = std::min(bestAdded, length - base);
+                }
+            }
+        }
+
+        RideInsertion ins = pool.assign(r);
+        if (bestAdded == std::numeric_limits<double>::infinity()) {
+            EXPECT_FALSE(ins.feasible()) << "request " << id;
+        }
+        else {
+            ASSERT_TRUE(ins.feasible()) << "request " << id;
+            EXPECT_NEAR(ins.addedDistance, bestAdded, 1e-6) << "request " << id;
+        }
+    }
+}
+
+TEST(RidePoolingTest, CapacityAndStopCompletion) {
+    Car car("Taxi", 60, 4, "Gasoline", 50, 0.08, 1);
+    RidePooling pool;
+    int v = pool.addVehicle(car, 0, 0);
+
+    RideRequest first = { 1, 1, 0, 10, 0, 0.05, 0.2 };
+    RideRequest second = { 2, 2, 0, 9, 0, 0.2, 2.0 };
+    EXPECT_TRUE(pool.assign(first).feasible());
+    // One seat: the second ride can only start after the first drop-off (0.3 h), too late.
+    EXPECT_FALSE(pool.findBestInsertion(second).feasible());
+    second.latestPickup = 0.5;
+    RideInsertion later = pool.findBestInsertion(second);
+    ASSERT_TRUE(later.feasible());
+    EXPECT_EQ(later.pickupIndex, 2);
+
+    pool.completeNextStop(v);
+    EXPECT_EQ(pool.getOnboard(v), 1);
+    ASSERT_EQ(pool.getStops(v).size(), 1u);
+    EXPECT_FALSE(pool.getStops(v)[0].pickup);
+    pool.completeNextStop(v);
+    EXPECT_EQ(pool.getOnboard(v), 0);
+    EXPECT_TRUE(pool.getStops(v).empty());
+}
+
+TEST(TiledEnvironmentTest, RoutesAcrossTilesWithEviction) {
+    // 10 x 10 grid of points 1 km apart, roads to the right and upwards.
+    Environment env;
+    auto point = [](int x, int y) { return Point("P" + std::to_string(x) + "_" + std::to_string(y), x, y); };
+    for (int x = 0; x < 10; x++) {
+        for (int y = 0; y < 10; y++) {
+            if (x + 1 < 10) env.addRoute(Route(point(x, y), point(x + 1, y), 1.0 + (y % 3)));
+            if (y + 1 < 10) env.addRoute(Route(point(x, y), point(x, y + 1), 1.0 + (x % 2)));
+        }
+    }
+    env.addObstacle(Obstacle("Storm", 2.5, 2.5));
+    env.addObstacle(Obstacle("Jam", 7.2, 8.1));
+
+    Graph<std::string> g(true); // Environment routes are directed
+    for (auto const& r : env.getRoutes())
+        g.add_edge(r.getStart().getName(), r.getDestination().getName(), static_cast<int>(r.getDistance()));
+
+    std::string path = ::testing::TempDir() + "tiles.tenv";
+    ASSERT_TRUE(TiledEnvironment::writeTiles(env, path, 3.0));
+
+    TiledEnvironment tiled(2000); // room for a few tiles only
+    ASSERT_TRUE(tiled.open(path));
+    EXPECT_EQ(tiled.tileCount(), 16u);
+    EXPECT_EQ(tiled.residentTiles(), 0u);
+
+    auto [route, distance] = tiled.findRoute(point(0, 0), point(9, 9));
+    ASSERT_FALSE(route.empty());
+    EXPECT_EQ(route.front().getName(), "P0_0");
+    EXPECT_EQ(route.back().getName(), "P9_9");
+    EXPECT_DOUBLE_EQ(distance, g.shortest_path("P0_0", "P9_9", false).second);
+    EXPECT_GT(tiled.tileLoads(), tiled.residentTiles()); // tiles were evicted and reloaded
+
+    auto obstacles = tiled.obstaclesIn(0, 0, 5, 5);
+    ASSERT_EQ(obstacles.size(), 1u);
+    EXPECT_EQ(obstacles[0].getDescription(), "Storm");
+    EXPECT_EQ(tiled.tileAt(100, 100), nullptr);
+    EXPECT_EQ(tiled.findRoute(point(0, 0), Point("Nowhere", 50, 50)).second, -1);
+    // Roads only go right and up: like Environment, the way back does not exist.
+    EXPECT_EQ(env.findRoute("P1_0", "P0_0"), nullptr);
+    EXPECT_EQ(tiled.findRoute(point(9, 9), point(0, 0)).second, -1);
+    EXPECT_EQ(tiled.findRoute(point(1, 0), point(0, 0)).second, -1);
+    std::remove(path.c_str());
+}
+
+TEST(TiledEnvironmentTest, RejectsMissingOrCorruptFile) {
+    TiledEnvironment tiled(1 << 20);
+    EXPECT_FALSE(tiled.open(::testing::TempDir() + "does_not_exist.tenv"));
+    EXPECT_EQ(tiled.tileCount(), 0u);
+
+    // Valid header claiming far more index entries than the file holds.
+    std::string path = ::testing::TempDir() + "corrupt.tenv";
+    {
+        std::ofstream out(path, std::ios::binary);
+        uint32_t version = 1, count = 0xFFFFFFFFu;
+        double tileSize = 1.0;
+        out.write("TENV", 4);
+        out.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        out.write(reinterpret_cast<const char*>(&tileSize), sizeof(tileSize));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    EXPECT_FALSE(tiled.open(path));
+    EXPECT_EQ(tiled.tileCount(), 0u);
+    std::remove(path.c_str());
+}
+
+TEST(EnvironmentTest, RouteIndexUpsertFindRemove) {
+    Environment env;
+    EXPECT_TRUE(env.addRoute(Route(Point("A", 0, 0), Point("B", 1, 0), 10.0)));
+    EXPECT_TRUE(env.addRoute(Route(Point("B", 1, 0), Point("A", 0, 0), 11.0))); // other direction
+    EXPECT_FALSE(env.addRoute(Route(Point("A", 0, 0), Point("B", 1, 0), 7.0))); // duplicate replaces
+    EXPECT_TRUE(env.addRoute(Route(Point("A", 0, 0), Point("C", 0, 1), 3.0)));
+    EXPECT_EQ(env.getRoutes().size(), 3u);
+    EXPECT_EQ(env.pointCount(), 3u);
+
+    ASSERT_NE(env.findRoute("A", "B"), nullptr);
+    EXPECT_DOUBLE_EQ(env.findRoute("A", "B")->getDistance(), 7.0);
+    EXPECT_EQ(env.findRoute("C", "A"), nullptr);
+    EXPECT_EQ(env.findRoute("X", "A"), nullptr);
+    EXPECT_EQ(env.routesAt("A").size(), 3u);
+    EXPECT_TRUE(env.routesAt("X").empty());
+
+    EXPECT_TRUE(env.removeRoute("A", "B"));
+    EXPECT_FALSE(env.removeRoute("A", "B"));
+    EXPECT_EQ(env.findRoute("A", "B"), nullptr);
+    ASSERT_NE(env.findRoute("A", "C"), nullptr);
+    EXPECT_DOUBLE_EQ(env.findRoute("A", "C")->getDistance(), 3.0);
+    EXPECT_EQ(env.routesAt("A").size(), 2u);
+    EXPECT_EQ(env.routesAt("B").size(), 1u);
+}
+
+TEST(EnvironmentTest, RouteIndexMatchesReferenceUnderChurn) {
+    Environment env;
+    std::map<std::pair<int, int>, double> reference;
+    unsigned state = 99;
+    auto next = [&state](int n) { state = state * 1103515245u + 12345u; return static_cast<int>((state >> 8) % n); };
+    auto name = [](int i) { return "P" + std::to_string(i); };
+
+    for (int step = 0; step < 5000; step++) {
+        int a = next(40), b = next(40);
+        if (next(3) == 0) {
+            EXPECT_EQ(env.removeRoute(name(a), name(b)), reference.erase({ a, b }) == 1);
+        }
+        else {
+            double d = next(1000);
+            EXPECT_EQ(env.addRoute(Route(Point(name(a), a, 0), Point(name(b), b, 0), d)), reference.count({ a, b }) == 0);
+            reference[{ a, b }] = d;
+        }
+    }
+
+    ASSERT_EQ(env.getRoutes().size(), reference.size());
+    for (auto const& [key, d] : reference) {
+        const Route* r = env.findRoute(name(key.first), name(key.second));
+        ASSERT_NE(r, nullptr);
+        EXPECT_DOUBLE_EQ(r->getDistance(), d);
+    }
+    // Every route is listed at both endpoints (once for a loop).
+    for (int p = 0; p < 40; p++) {
+        size_t expected = 0;
+        for (auto const& [key, d] : reference) expected += key.first == p || key.second == p;
+        EXPECT_EQ(env.routesAt(name(p)).size(), expected);
+        for (int r : env.routesAt(name(p))) {
+            const Route& route = env.getRoutes()[r];
+            EXPECT_TRUE(route.getStart().getName() == name(p) || route.getDestination().getName() == name(p));
+        }
+    }
+}
+
+// Checks dbscan against the O(n^2) definition: core flags, one cluster per
+// connected component of core points, border points labeled after a core neighbor.
+static void expectDbscanMatchesBruteForce(const std::vector<double>& xs, const std::vector<double>& ys,
+    double eps, int minPoints) {
+    const int n = static_cast<int>(xs.size());
+    auto close = [&](int a, int b) { return std::hypot(xs[a] - xs[b], ys[a] - ys[b]) <= eps; };
+    std::vector<char> core(n, 0);
+    for (int a = 0; a < n; a++) {
+        int count = 0;
+        for (int b = 0; b < n; b++) count += close(a, b);
+        core[a] = count >= minPoints;
+    }
+    std::vector<int> component(n, -1);
+    for (int a = 0; a < n; a++) {
+        if (!core[a] || component[a] >= 0) continue;
+        std::vector<int> stack = { a };
+        component[a] = a;
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            for (int b = 0; b < n; b++)
+                if (core[b] && component[b] < 0 && close(u, b)) {
+                    component[b] = a;
+                    stack.push_back(b);
+                }
+        }
+    }
+
+    for (int threads : { 1, 4 }) {
+        DbscanResult result = dbscan(xs, ys, eps, minPoints, threads);
+        ASSERT_EQ(result.labels.size(), xs.size());
+        std::map<int, int> clusterOfComponent;
+        for (int a = 0; a < n; a++) {
+            EXPECT_EQ(result.core[a], core[a]) << a;
+            if (core[a]) {
+                auto [it, inserted] = clusterOfComponent.emplace(component[a], result.labels[a]);
+                EXPECT_EQ(it->second, result.labels[a]) << a;
+            }
+        }
+        EXPECT_EQ(result.clusterCount, static_cast<int>(clusterOfComponent.size()));
+        for (int a = 0; a < n; a++) {
+            if (core[a]) continue;
+            bool hasCoreNeighbor = false, labelMatches = false;
+            for (int b = 0; b < n; b++)
+                if (core[b] && close(a, b)) {
+                    hasCoreNeighbor = true;
+                    labelMatches |= clusterOfComponent[component[b]] == result.labels[a];
+                }
+            if (hasCoreNeighbor) EXPECT_TRUE(labelMatches) << a;
+            else EXPECT_EQ(result.labels[a], -1) << a;
+        }
+    }
+}
+
+TEST(DbscanTest, MatchesBruteForce) {
+    std::vector<double> xs, ys;
+    unsigned state = 5;
+    auto next = [&state]() { state = state * 1103515245u + 12345u; return (state >> 8) % 100000 / 1000.0; };
+    // Dense blobs plus uniform noise.
+    for (int blob = 0; blob < 6; blob++) {
+        double cx = next(), cy = next();
+        for (int i = 0; i < 80; i++) {
+            xs.push_back(cx + next() / 25);
+            ys.push_back(cy + next() / 25);
+        }
+    }
+    for (int i = 0; i < 300; i++) {
+        xs.push_back(next());
+        ys.push_back(next());
+    }
+    expectDbscanMatchesBruteForce(xs, ys, 1.5, 5);
+}
+
+TEST(DbscanTest, HugeExtentCoarsensGridButMatchesBruteForce) {
+    // Two groups 1e10 apart: with eps = 1 the grid is capped at 2^30 cells per
+    // axis, so cells are about 9.3 wide and hold points that are not neighbors.
+    std::vector<double> xs, ys;
+    unsigned state = 11;
+    auto next = [&state]() { state = state * 1103515245u + 12345u; return (state >> 8) % 100000 / 5000.0; };
+    for (double offset : { 0.0, 1e10 }) {
+        for (int i = 0; i < 150; i++) {
+            xs.push_back(offset + next());
+            ys.push_back(offset + next());
+        }
+    }
+    // A tight blob that is entirely core, and a chain of points 0.9 apart that
+    // puts minPoints points in one cell although none of them is core.
+    for (int i = 0; i < 6; i++) {
+        xs.push_back(50 + 0.01 * i);
+        ys.push_back(50);
+    }
+    for (int i = 0; i < 8; i++) {
+        xs.push_back(70 + 0.9 * i);
+        ys.push_back(70);
+    }
+    expectDbscanMatchesBruteForce(xs, ys, 1.0, 4);
+}
+
+TEST(DbscanTest, ClustersObstacleReports) {
+    std::vector<Obstacle> reports = { Obstacle("Jam", 0, 0), Obstacle("Jam", 0.5, 0), Obstacle("Jam", 0, 0.5),
+                                      Obstacle("Jam", 10, 10), Obstacle("Jam", 10.4, 10), Obstacle("Jam", 10, 10.3),
+                                      Obstacle("Storm", 50, 50) };
+    DbscanResult result = dbscan(reports, 1.0, 3);
+    EXPECT_EQ(result.clusterCount, 2);
+    EXPECT_EQ(result.labels, (std::vector<int>{ 0, 0, 0, 1, 1, 1, -1 }));
+}
+
+TEST(HeatmapTest, BatchAndLiveUpdatesAggregateIntoPyramid) {
+    Heatmap heatmap(0, 0, 100, 100, 8);
+    EXPECT_EQ(heatmap.levelCount(), 4); // 8, 4, 2, 1 cells per axis
+
+    FleetPositions fleet;
+    for (int i = 0; i < 20000; i++) fleet.add((i % 100) + 0.5, (i / 100 % 100) + 0.5);
+    heatmap.recordBatch(fleet, 4);
+
+    std::vector<std::thread> writers;
+    for (int t = 0; t < 4; t++)
+        writers.emplace_back([&heatmap]() {
+            for (int i = 0; i < 1000; i++) heatmap.record(99, 1); // bottom-right cell
+        });
+    for (auto& w : writers) w.join();
+    heatmap.record(-5, 500); // clamped to the top-left cell
+
+    auto levels = heatmap.pyramid(2);
+    ASSERT_EQ(levels.size(), 4u);
+    EXPECT_EQ(levels[3][0], 20000u + 4000u + 1u);
+    // Each of the 100 x 100 positions was recorded twice; cells are 12.5 wide.
+    EXPECT_EQ(levels[0][7], 13u * 12 * 2 + 4000);   // x 87..99, y 0..11, plus the live updates
+    EXPECT_EQ(levels[0][7 * 8], 12u * 13 * 2 + 1);  // x 0..11, y 87..99, plus the clamped one
+    EXPECT_EQ(heatmap.level(1, 3), levels[1]);
+
+    heatmap.reset();
+    EXPECT_EQ(heatmap.level(3)[0], 0u);
+}
+
+TEST(HeatmapTest, FarOutAndNaNPositionsAreClamped) {
+    Heatmap heatmap(0, 0, 100, 100, 8);
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    heatmap.record(1e300, -1e300); // far beyond int range: bottom-right cell
+    heatmap.record(std::numeric_limits<double>::infinity(), 1);
+    FleetPositions fleet;
+    fleet.add(nan, nan);
+    fleet.add(nan, 1e20);
+    heatmap.recordBatch(fleet, 1);
+
+    auto cells = heatmap.level(0);
+    EXPECT_EQ(cells[7], 2u);
+    EXPECT_EQ(cells[0], 1u);     // NaN maps to the first cell
+    EXPECT_EQ(cells[7 * 8], 1u); // NaN x, far-out y
+    EXPECT_EQ(heatmap.level(3)[0], 4u);
+}
+
+TEST(HeatmapTest, ShardsOfExitedThreadsAreReused) {
+    ShardedCounters counters(16);
+    for (int round = 0; round < 8; round++)
+        std::thread([&counters, round]() { counters.add(round, 3); }).join();
+    EXPECT_EQ(counters.shardCount(), 1u); // every thread took over the previous one's shard
+    std::vector<uint64_t> totals = counters.snapshot();
+    for (int i = 0; i < 16; i++) EXPECT_EQ(totals[i], i < 8 ? 3u : 0u) << i;
+
+    // Counters are 64-bit and do not wrap at 2^32.
+    counters.add(15, uint64_t(1) << 32);
+    counters.add(15, uint64_t(1) << 32);
+    EXPECT_EQ(counters.snapshot()[15], uint64_t(1) << 33);
+}
+
+TEST(HeatmapTest, EdgeUsageCountsRoutes) {
+    Graph<int> g;
+    g.add_edge(1, 2, 1);
+    g.add_edge(2, 3, 1);
+    g.add_edge(3, 4, 1);
+    FrozenGraph<int> fg(g);
+    EdgeUsage<int> usage(fg);
+
+    std::vector<std::thread> drivers;
+    for (int t = 0; t < 3; t++)
+        drivers.emplace_back([&usage]() {
+            for (int i = 0; i < 100; i++) {
+                usage.recordPath({ 1, 2, 3 });
+                usage.recordPath({ 3, 2 });
+            }
+        });
+    for (auto& d : drivers) d.join();
+    usage.recordPath({ 3, 4, 9 }); // 4-9 is not an edge
+
+    auto top = usage.top(5);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0], std::make_tuple(2, 3, uint64_t(600)));
+    EXPECT_EQ(top[1], std::make_tuple(1, 2, uint64_t(300)));
+    EXPECT_EQ(top[2], std::make_tuple(3, 4, uint64_t(1)));
+}
+
+TEST(GraphExportTest, TextFormatsListEachEdgeOnce) {
+    Graph<int> g;
+    g.add_edge(1, 2, 5);
+    g.add_edge(2, 3, 7);
+    g.add_vertex(4);
+
+    EXPECT_EQ(export_graph(g, GraphFormat::Dot),
+        "graph G {\n  1 -- 2 [weight=5];\n  2 -- 3 [weight=7];\n  4;\n}\n");
+    EXPECT_EQ(export_graph(g, GraphFormat::Json),
+        "{\"directed\":false,\"nodes\":[1,2,3,4],\"edges\":[{\"source\":1,\"target\":2,\"weight\":5},"
+        "{\"source\":2,\"target\":3,\"weight\":7}]}\n");
+    std::string xml = export_graph(g, GraphFormat::GraphML);
+    EXPECT_NE(xml.find("edgedefault=\"undirected\""), std::string::npos);
+    EXPECT_NE(xml.find("<edge source=\"2\" target=\"3\"><data key=\"weight\">7</data></edge>"), std::string::npos);
+
+    Graph<std::string> named(true);
+    named.add_edge("a\"b", "<c>", 1);
+    EXPECT_EQ(export_graph(named, GraphFormat::Dot), "digraph G {\n  \"<c>\";\n  \"a\\\"b\" -> \"<c>\" [weight=1];\n}\n");
+    EXPECT_NE(export_graph(named, GraphFormat::GraphML).find("<node id=\"&lt;c&gt;\"/>"), std::string::npos);
+    EXPECT_EQ(export_graph(named, GraphFormat::BinaryEdgeList), "");
+}
+
+TEST(GraphExportTest, ParallelOutputMatchesSequentialAndFile) {
+    Graph<int> g;
+    for (int v = 0; v < 150000; v++) g.add_edge(v, (v * 7 + 3) % 150000, v % 13 + 1);
+
+    for (GraphFormat format : { GraphFormat::Dot, GraphFormat::GraphML, GraphFormat::Json, GraphFormat::BinaryEdgeList })
+        EXPECT_EQ(export_graph(g, format, 4), export_graph(g, format, 1));
+
+    std::string binary = export_graph(g, GraphFormat::BinaryEdgeList, 3);
+    ASSERT_GE(binary.size(), 16u);
+    EXPECT_EQ(binary.compare(0, 4, "GEL1"), 0);
+    uint64_t edges = 0;
+    std::memcpy(&edges, binary.data() + 8, sizeof(edges));
+    EXPECT_EQ(binary.size(), 16 + edges * BinaryEdgeRecordSize);
+
+    std::string path = ::testing::TempDir() + "graph_export.json";
+    ASSERT_TRUE(export_graph(g, path, GraphFormat::Json, 2));
+    std::ifstream in(path, std::ios::binary);
+    std::string written((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    EXPECT_EQ(written, export_graph(g, GraphFormat::Json));
+    std::remove(path.c_str());
+    EXPECT_FALSE(export_graph(g, ::testing::TempDir() + "missing/dir/graph.dot", GraphFormat::Dot));
+}
+
+TEST(OsmImportTest, XmlKeepsJunctionsAndOneways) {
+    std::string path = ::testing::TempDir() + "osm_import.osm";
+    {
+        std::ofstream out(path);
+        out << "<?xml version='1.0' encoding='UTF-8'?>\n<osm version=\"0.6\">\n"
+               " <node id=\"1\" lat=\"0\" lon=\"0\"/>\n"
+               " <node id=\"2\" lat=\"0\" lon=\"0.001\"/>\n"
+               " <node id=\"3\" lat=\"0\" lon=\"0.002\">\n  <tag k=\"name\" v=\"Market &amp; Square\"/>\n </node>\n"
+               " <node id=\"4\" lat=\"0\" lon=\"0.003\"/>\n"
+               " <node id=\"5\" lat=\"0\" lon=\"0.004\"/>\n"
+               " <node id=\"6\" lat=\"0.001\" lon=\"0.001\"/>\n"
+               " <way id=\"10\">\n  <nd ref=\"1\"/><nd ref=\"2\"/><nd ref=\"3\"/>\n  <tag k=\"highway\" v=\"residential\"/>\n </way>\n"
+               " <way id=\"11\">\n  <nd ref=\"3\"/><nd ref=\"4\"/><nd ref=\"5\"/>\n"
+               "  <tag k=\"highway\" v=\"primary\"/><tag k=\"oneway\" v=\"yes\"/>\n </way>\n"
+               " <way id=\"12\">\n  <nd ref=\"2\"/><nd ref=\"6\"/>\n  <tag k=\"highway\" v=\"footway\"/>\n </way>\n"
+               " <way id=\"13\">\n  <nd ref=\"5\"/><nd ref=\"6\"/>\n  <tag k=\"railway\" v=\"rail\"/>\n </way>\n"
+               " <relation id=\"20\">\n  <member type=\"way\" ref=\"10\" role=\"\"/>\n </relation>\n"
+               "</osm>\n";
+    }
+
+    OsmNetwork network;
+    Environment env;
+    ASSERT_TRUE(importOsm(path, network, OsmImportOptions(), &env));
+    EXPECT_EQ(network.wayCount, 2u);
+    EXPECT_EQ(network.segmentCount, 2u);
+    ASSERT_EQ(network.nodeIds, (std::vector<long long>{ 1, 3, 5 }));
+    EXPECT_EQ(network.points[1].getName(), "Market & Square (node/3)");
+    EXPECT_DOUBLE_EQ(network.points[2].getX(), 0.004);
+
+    auto [path15, meters] = network.graph.shortest_path(0, 2, false);
+    EXPECT_EQ(path15, (std::vector<int>{ 0, 1, 2 }));
+    EXPECT_NEAR(meters, 445, 1);
+    EXPECT_EQ(network.graph.shortest_path(2, 0, false).second, -1); // 3 -> 5 is one-way
+
+    // Way 10 is two-way, so its segment is a route in each direction; way 11 is one-way.
+    EXPECT_EQ(env.getRoutes().size(), 3u);
+    const Route* route = env.findRoute("Market & Square (node/3)", "node/5");
+    ASSERT_NE(route, nullptr);
+    EXPECT_NEAR(route->getDistance(), 0.222, 0.001);
+    EXPECT_EQ(env.findRoute("node/5", "Market & Square (node/3)"), nullptr);
+    const Route* forward = env.findRoute("node/1", "Market & Square (node/3)");
+    const Route* backward = env.findRoute("Market & Square (node/3)", "node/1");
+    ASSERT_NE(forward, nullptr);
+    ASSERT_NE(backward, nullptr);
+    EXPECT_NEAR(forward->getDistance(), 0.222, 0.001);
+    EXPECT_DOUBLE_EQ(backward->getDistance(), forward->getDistance());
+
+    OsmImportOptions withRail;
+    withRail.rail = true;
+    withRail.threads = 3;
+    ASSERT_TRUE(importOsm(path, network, withRail));
+    EXPECT_EQ(network.nodeIds, (std::vector<long long>{ 1, 3, 5, 6 }));
+    std::remove(path.c_str());
+    EXPECT_FALSE(importOsm(path, network));
+}
+
+namespace {
+    // Protobuf encoding helpers for building a small .osm.pbf file.
+    void pbVarint(std::string& out, uint64_t v) {
+        while (v >= 0x80) {
+            out += static_cast<char>(v | 0x80);
+            v >>= 7;
+        }
+        out += static_cast<char>(v);
+    }
+    void pbKey(std::string& out, int field, int wire) { pbVarint(out, static_cast<uint64_t>(field) << 3 | wire); }
+    void pbBytes(std::string& out, int field, const std::string& bytes) {
+        pbKey(out, field, 2);
+        pbVarint(out, bytes.size());
+        out += bytes;
+    }
+    std::string pbPacked(const std::vector<int64_t>& values, bool zigzagDelta) {
+        std::string out;
+        int64_t previous = 0;
+        for (int64_t v : values) {
+            if (!zigzagDelta) {
+                pbVarint(out, static_cast<uint64_t>(v));
+                continue;
+            }
+            int64_t d = v - previous;
+            previous = v;
+            pbVarint(out, static_cast<uint64_t>((d << 1) ^ (d >> 63)));
+        }
+        return out;
+    }
+    void pbBlob(std::string& file, const std::string& type, const std::string& block, bool compress) {
+        std::string blob;
+        if (compress) {
+            uLongf size = compressBound(block.size());
+            std::string packed(size, '\0');
+            compress2(reinterpret_cast<Bytef*>(&packed[0]), &size, reinterpret_cast<const Bytef*>(block.data()), block.size(), 6);
+            packed.resize(size);
+            pbKey(blob, 2, 0);
+            pbVarint(blob, block.size());
+            pbBytes(blob, 3, packed);
+        }
+        else {
+            pbBytes(blob, 1, block);
+        }
+        std::string header;
+        pbBytes(header, 1, type);
+        pbKey(header, 3, 0);
+        pbVarint(header, blob.size());
+        for (int shift = 24; shift >= 0; shift -= 8) file += static_cast<char>(header.size() >> shift);
+        file += header + blob;
+    }
+}
+
+TEST(OsmImportTest, PbfDenseNodesAndCompressedWays) {
+    std::string table;
+    for (std::string s : { "", "highway", "residential", "name", "Hub", "service" }) pbBytes(table, 1, s);
+
+    // Nodes 100..103 on a line, 0.001 degrees apart; 101 is named.
+    std::string dense;
+    pbBytes(dense, 1, pbPacked({ 100, 101, 102, 103 }, true));
+    pbBytes(dense, 8, pbPacked({ 0, 0, 0, 0 }, true));
+    pbBytes(dense, 9, pbPacked({ 0, 10000, 20000, 30000 }, true));
+    pbBytes(dense, 10, pbPacked({ 0, 3, 4, 0, 0, 0 }, false));
+    std::string nodes, group;
+    pbBytes(group, 2, dense);
+    pbBytes(nodes, 1, table);
+    pbBytes(nodes, 2, group);
+
+    auto way = [](int64_t id, std::vector<int64_t> refs, int64_t kind) {
+        std::string w;
+        pbKey(w, 1, 0);
+        pbVarint(w, static_cast<uint64_t>(id));
+        pbBytes(w, 2, pbPacked({ 1 }, false));
+        pbBytes(w, 3, pbPacked({ kind }, false));
+        pbBytes(w, 8, pbPacked(refs, true));
+        return w;
+    };
+    std::string ways, wayGroup;
+    pbBytes(wayGroup, 3, way(7, { 100, 101 }, 2));
+    pbBytes(wayGroup, 3, way(8, { 101, 102, 103 }, 5));
+    pbBytes(ways, 1, table);
+    pbBytes(ways, 2, wayGroup);
+
+    std::string header, file;
+    pbBytes(header, 4, "OsmSchema-V0.6");
+    pbBytes(header, 4, "DenseNodes");
+    pbBlob(file, "OSMHeader", header, false);
+    pbBlob(file, "OSMData", nodes, false);
+    pbBlob(file, "OSMData", ways, true);
+
+    std::string path = ::testing::TempDir() + "osm_import.osm.pbf";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << file;
+    }
+    OsmNetwork network;
+    OsmImportOptions options;
+    options.threads = 2;
+    ASSERT_TRUE(importOsm(path, network, options));
+    EXPECT_EQ(network.wayCount, 2u);
+    ASSERT_EQ(network.nodeIds, (std::vector<long long>{ 100, 101, 103 }));
+    EXPECT_EQ(network.points[1].getName(), "Hub (node/101)");
+    EXPECT_NEAR(network.points[2].getX(), 0.003, 1e-12);
+    auto [route, meters] = network.graph.shortest_path(2, 0, false);
+    EXPECT_EQ(route, (std::vector<int>{ 2, 1, 0 }));
+    EXPECT_NEAR(meters, 334, 1);
+
+    // Truncated files are rejected.
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << file.substr(0, file.size() - 5);
+    }
+    EXPECT_FALSE(importOsm(path, network));
+    std::remove(path.c_str());
+}
+
+TEST(PathCodecTest, EncodingsRoundTrip) {
+    Graph<int> g;
+    for (int r = 0; r < 20; r++)
+        for (int c = 0; c < 20; c++) {
+            if (c + 1 < 20) g.add_edge(r * 20 + c, r * 20 + c + 1, 1 + (r * c) % 5);
+            if (r + 1 < 20) g.add_edge(r * 20 + c, (r + 1) * 20 + c, 1 + (r + c) % 3);
+        }
+    g.add_edge(399, 1000, 1); // dead end of degree 1
+    FrozenGraph<int> fg(g);
+    PathCodec<int> codec(fg);
+
+    std::vector<std::vector<int>> paths = { {}, { 7 }, fg.shortest_path(0, 399, false).first,
+        fg.shortest_path(1000, 21, false).first, fg.shortest_path(380, 19, false).first };
+    std::string packed, deltas;
+    for (auto const& p : paths) {
+        ASSERT_TRUE(codec.encode(p, packed));
+        append_path_delta(p, deltas);
+    }
+    size_t pos = 0, deltaPos = 0;
+    for (auto const& p : paths) {
+        std::vector<int> decoded;
+        ASSERT_TRUE(codec.decode(packed, pos, decoded));
+        EXPECT_EQ(decoded, p);
+        ASSERT_TRUE(read_path_delta(deltas, deltaPos, decoded));
+        EXPECT_EQ(decoded, p);
+    }
+    EXPECT_EQ(pos, packed.size());
+    EXPECT_EQ(deltaPos, deltas.size());
+    // At most 2 bits per hop on a grid, against 4 bytes per vertex as vector<int>.
+    EXPECT_LT(packed.size() * 8, (paths[2].size() + paths[3].size() + paths[4].size()) * 4);
+
+    std::string rejected;
+    EXPECT_FALSE(codec.encode({ 0, 2 }, rejected)); // not adjacent
+    EXPECT_FALSE(codec.encode({ 0, 1, 5000 }, rejected));
+    EXPECT_TRUE(rejected.empty());
+    std::vector<int> decoded;
+    size_t truncated = 0;
+    std::string_view head = std::string_view(packed).substr(0, 6); // empty path, { 7 }, part of the third
+    ASSERT_TRUE(codec.decode(head, truncated, decoded));
+    ASSERT_TRUE(codec.decode(head, truncated, decoded));
+    EXPECT_FALSE(codec.decode(head, truncated, decoded));
+}
+
+TEST(PathCodecTest, ArchiveGivesRandomAccess) {
+    Graph<int> g;
+    for (int v = 0; v < 500; v++) {
+        g.add_edge(v, (v + 1) % 500, 1 + v % 7);
+        g.add_edge(v, (v * 37 + 11) % 500, 3 + v % 5);
+    }
+    FrozenGraph<int> fg(g);
+    PathCodec<int> codec(fg);
+    PathArchiveWriter<int> writer(codec);
+    std::vector<std::vector<int>> paths;
+    for (int i = 0; i < 300; i++) {
+        paths.push_back(fg.shortest_path(i, (i * 97 + 13) % 500, false).first);
+        EXPECT_EQ(writer.add(paths.back()), i);
+    }
+    EXPECT_EQ(writer.add({ 0, 250 }), -1);
+    EXPECT_EQ(writer.size(), 300u);
+
+    std::string path = ::testing::TempDir() + "paths.parc";
+    ASSERT_TRUE(writer.write(path));
+    PathArchive<int> archive(codec);
+    ASSERT_TRUE(archive.open(path));
+    ASSERT_EQ(archive.size(), 300u);
+    for (size_t id : { 299u, 0u, 150u, 17u }) {
+        EXPECT_EQ(archive.get(id), paths[id]);
+        EXPECT_EQ(archive.hopCount(id), paths[id].size() - 1);
+    }
+    std::vector<int> out;
+    EXPECT_FALSE(archive.get(300, out));
+    EXPECT_EQ(archive.hopCount(300), 0u);
+    archive.close();
+
+    // The same shape with renumbered vertices does not match either.
+    Graph<int> renumbered;
+    for (int v = 0; v < 500; v++) {
+        renumbered.add_edge(v + 1000, (v + 1) % 500 + 1000, 1 + v % 7);
+        renumbered.add_edge(v + 1000, (v * 37 + 11) % 500 + 1000, 3 + v % 5);
+    }
+    FrozenGraph<int> shifted(renumbered);
+    ASSERT_EQ(shifted.getTargets(), fg.getTargets());
+    PathCodec<int> shiftedCodec(shifted);
+    PathArchive<int> wrongLabels(shiftedCodec);
+    EXPECT_FALSE(wrongLabels.open(path));
+
+    // Another graph has another fingerprint.
+    g.add_edge(0, 499, 1);
+    FrozenGraph<int> other(g);
+    PathCodec<int> otherCodec(other);
+    PathArchive<int> wrongGraph(otherCodec);
+    EXPECT_FALSE(wrongGraph.open(path));
+
+    // Truncated files are rejected.
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out << bytes.substr(0, bytes.size() - 3);
+    }
+    EXPECT_FALSE(archive.open(path));
+    std::remove(path.c_str());
+}
+
+namespace {
+    template<typename V>
+    std::map<V, std::vector<std::pair<V, int>>> sortedAdjacency(const Graph<V>& g) {
+        std::map<V, std::vector<std::pair<V, int>>> result;
+        for (auto const& [v, neighbors] : g.getAdjacency()) {
+            auto& list = result[v];
+            list.assign(neighbors.begin(), neighbors.end());
+            std::sort(list.begin(), list.end());
+        }
+        return result;
+    }
+
+    template<typename V>
+    void expectSameSnapshot(const FrozenGraph<V>& a, const FrozenGraph<V>& b) {
+        ASSERT_EQ(a.vertex_count(), b.vertex_count());
+        for (int i = 0; i < a.vertex_count(); i++) EXPECT_EQ(a.vertex_at(i), b.vertex_at(i));
+        EXPECT_TRUE(std::equal(a.getOffsets().begin(), a.getOffsets().end(), b.getOffsets().begin(), b.getOffsets().end()));
+        EXPECT_TRUE(std::equal(a.getTargets().begin(), a.getTargets().end(), b.getTargets().begin(), b.getTargets().end()));
+        EXPECT_TRUE(std::equal(a.getWeights().begin(), a.getWeights().end(), b.getWeights().begin(), b.getWeights().end()));
+    }
+}
+
+TEST(GraphDeltaTest, DiffAppliesToGraphAndFrozenGraph) {
+    for (bool directed : { false, true }) {
+        Graph<int> before(directed);
+        for (int v = 0; v < 60; v++) {
+            before.add_edge(v, (v + 1) % 60, 1 + v % 9);
+            before.add_edge(v, (v * 7 + 3) % 60, 2 + v % 4);
+        }
+        before.add_edge(10, 11, 4); // parallel edge
+
+        Graph<int> after = before;
+        after.remove_vertex(5);
+        after.remove_edge(20, 21);
+        after.set_edge_weight(30, 31, 99);
+        after.set_edge_weight(10, 11, 7);
+        after.add_edge(40, 41, 3);
+        after.add_edge(100, 2, 8);
+        after.add_edge(100, 100, 1);
+        after.add_vertex(200);
+        after.remove_vertex(7);
+        after.add_edge(7, 8, 5);
+
+        GraphDelta<int> delta = diff_graphs(before, after);
+        EXPECT_EQ(delta.directed, directed);
+        EXPECT_EQ(delta.removedVertices, std::vector<int>{ 5 });
+        EXPECT_EQ(delta.addedVertices, (std::vector<int>{ 100, 200 }));
+        EXPECT_TRUE(diff_graphs(after, after).empty());
+
+        Graph<int> patched = before;
+        ASSERT_TRUE(apply_delta(patched, delta));
+        EXPECT_EQ(sortedAdjacency(patched), sortedAdjacency(after));
+
+        FrozenGraph<int> frozen(before), result;
+        ASSERT_TRUE(frozen.patch(delta, result));
+        expectSameSnapshot(result, FrozenGraph<int>(patched));
+        EXPECT_EQ(result.shortest_path(0, 100, false).second, FrozenGraph<int>(after).shortest_path(0, 100, false).second);
+
+        // Weight changes only: the vertex set is unchanged; patching in place works.
+        GraphDelta<int> weights;
+        weights.directed = directed;
+        weights.changedWeights = { { 1, 2, 50 }, { 45, 46, 0 } };
+        Graph<int> reweighted = before;
+        apply_delta(reweighted, weights);
+        ASSERT_TRUE(frozen.patch(weights, frozen));
+        expectSameSnapshot(frozen, FrozenGraph<int>(reweighted));
+
+        weights.directed = !directed;
+        EXPECT_FALSE(apply_delta(reweighted, weights));
+        EXPECT_FALSE(frozen.patch(weights, result));
+    }
+}
+
+TEST(GraphDeltaTest, BinaryPatchRoundTrips) {
+    GraphDelta<long long> delta;
+    delta.directed = true;
+    delta.fromVersion = 41;
+    delta.toVersion = 42;
+    delta.removedVertices = { 9000000000LL, -3 };
+    delta.removedEdges = { { 1, 2 }, { 5, -5 } };
+    delta.changedWeights = { { 7, 8, -1 }, { 7, 9, 2147483647 } };
+    delta.addedVertices = { 12 };
+    delta.addedEdges = { { 12, 13, 4 }, { 12, 11, 5 }, { -1, 9000000000LL, 6 } };
+
+    std::string patch = encode_graph_delta(delta);
+    GraphDelta<long long> decoded;
+    ASSERT_TRUE(decode_graph_delta(patch, decoded));
+    EXPECT_EQ(decoded.directed, delta.directed);
+    EXPECT_EQ(decoded.fromVersion, 41u);
+    EXPECT_EQ(decoded.toVersion, 42u);
+    EXPECT_EQ(decoded.removedVertices, delta.removedVertices);
+    EXPECT_EQ(decoded.removedEdges, delta.removedEdges);
+    EXPECT_EQ(decoded.changedWeights, delta.changedWeights);
+    EXPECT_EQ(decoded.addedVertices, delta.addedVertices);
+    EXPECT_EQ(decoded.addedEdges, delta.addedEdges);
+
+    EXPECT_EQ(encode_graph_delta(GraphDelta<int>()).size(), 12u);
+    EXPECT_FALSE(decode_graph_delta(std::string_view(patch).substr(0, patch.size() - 1), decoded));
+    EXPECT_FALSE(decode_graph_delta(patch + '\0', decoded));
+    patch[0] = 'X';
+    EXPECT_FALSE(decode_graph_delta(patch, decoded));
+    EXPECT_EQ(decoded.toVersion, 42u);
+}
+
+TEST(EdgeRelaxTest, KernelsMatchScalarLoop) {
+    const int n = 64, count = 203;
+    std::vector<int> targets(count), weights(count);
+    std::vector<long long> start(n);
+    unsigned seed = 12345;
+    auto next = [&seed]() { return seed = seed * 1103515245u + 12345u, (seed >> 8) % 1000; };
+    for (int i = 0; i < count; i++) {
+        targets[i] = static_cast<int>(next() % n); // plenty of repeated targets
+        weights[i] = static_cast<int>(next() % 50);
+    }
+    for (int v = 0; v < n; v++) start[v] = v % 5 == 0 ? std::numeric_limits<long long>::max() : 100 + next() % 40;
+
+    RelaxKernel initial = active_relax_kernel();
+    std::vector<long long> expectedDist = start;
+    std::vector<int> expectedParent(n, -1);
+    for (int i = 0; i < count; i++) {
+        if (120 + weights[i] < expectedDist[targets[i]]) {
+            expectedDist[targets[i]] = 120 + weights[i];
+            expectedParent[targets[i]] = 7;
+        }
+    }
+
+    for (RelaxKernel kernel : { RelaxKernel::Scalar, RelaxKernel::Avx2, RelaxKernel::Avx512 }) {
+        if (!select_relax_kernel(kernel)) continue;
+        std::vector<long long> dist = start, improvedDist(count);
+        std::vector<int> parent(n, -1), improvedVertex(count);
+        int improved = relax_edges(targets.data(), weights.data(), count, 120, 7, dist.data(), parent.data(),
+            improvedVertex.data(), improvedDist.data());
+        EXPECT_EQ(dist, expectedDist);
+        EXPECT_EQ(parent, expectedParent);
+        // Every improved vertex is reported with its final distance; other entries are stale.
+        std::vector<char> reported(n, 0);
+        for (int i = 0; i < improved; i++) {
+            int v = improvedVertex[i];
+            EXPECT_LT(improvedDist[i], start[v]);
+            EXPECT_GE(improvedDist[i], dist[v]);
+            if (improvedDist[i] == dist[v]) reported[v] = 1;
+        }
+        for (int v = 0; v < n; v++) EXPECT_EQ(reported[v] != 0, dist[v] != start[v]);
+    }
+    EXPECT_TRUE(select_relax_kernel(initial));
+    EXPECT_TRUE(relax_kernel_supported(RelaxKernel::Scalar));
+}
+
+TEST(EdgeRelaxTest, FrozenShortestPathWithEachKernel) {
+    Graph<int> g(true);
+    for (int u = 0; u < 300; u++)
+        for (int k = 1; k <= 40; k++)
+            g.add_edge(u, (u * 31 + k * 17) % 300, 1 + (u * k) % 97);
+    FrozenGraph<int> fg(g);
+    RelaxKernel initial = active_relax_kernel();
+    for (RelaxKernel kernel : { RelaxKernel::Scalar, RelaxKernel::Avx2, RelaxKernel::Avx512 }) {
+        if (!select_relax_kernel(kernel)) continue;
+        for (int t : { 1, 99, 250, 299 }) {
+            auto [path, distance] = fg.shortest_path(0, t, false);
+            EXPECT_EQ(distance, g.shortest_path(0, t, false).second);
+            ASSERT_FALSE(path.empty());
+            EXPECT_EQ(path.front(), 0);
+            EXPECT_EQ(path.back(), t);
+        }
+    }
+    select_relax_kernel(initial);
+}